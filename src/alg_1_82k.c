@@ -36,7 +36,8 @@ sched_algorithm_t alg_1_82k = {
     alg_1_82k_calculate,
     alg_1_82k_job_free,
     alg_1_82k_job_compare,
-    alg_1_82k_inc_limit_job
+    alg_1_82k_inc_limit_job,
+    &graph_model_2_1
 };
 
 void alg_1_82k_calculate( sched_t *sched, void *job ) {
@@ -65,7 +66,7 @@ void alg_1_82k_calculate( sched_t *sched, void *job ) {
 
 
     tmp = (graphstate_t *)sched_getBest( sched );
-    graphstate_lock( graphstate, 2, 1 );
+    graphstate_lock( graphstate, &graph_model_2_1 );
     if( graphstate->cost_left < 0 ) { /* If no cost is left, leave it */
         graphstate_unlock( graphstate );
         graphstate_decref( graphstate );
@@ -265,7 +266,7 @@ void alg_1_82k_calculate( sched_t *sched, void *job ) {
                                         if ( !val && (edge_setup & edge) )
                                             chs[i] = graph_setPersistant(g, a, b);
                                         if (chs[i] != NULL)
-                                            cost = graph_apply(g, chs[i], 2, 1);
+                                            cost = graph_apply(g, chs[i], &graph_model_2_1);
 
                                         i++;
                                         edge << 1;
@@ -280,11 +281,11 @@ void alg_1_82k_calculate( sched_t *sched, void *job ) {
                                 }
                                 edge_setup++;
                                 /* step back to were we were at the start */
-                                graphstate_lock( graphstate, 2, 1);
+                                graphstate_lock( graphstate, &graph_model_2_1 );
                             }
                             
                             for( i=0; i < 6; i++){
-                                graph_apply(g, chs[i], 2, 1);
+                                graph_apply(g, chs[i], &graph_model_2_1);
                             }
 
                         } else if ( edges - 1 == ( ( nodes * ( nodes - 1 ) )^2 ) / 2 ) {
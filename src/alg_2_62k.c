@@ -24,17 +24,23 @@
 #include "graphstate.h"
 
 #include "kernel.h"
+#include "mincut.h"
+#include "pairsum.h"
+#include "branch.h"
 
 void alg_2_62k_calculate( sched_t *sched, void *job );
 void alg_2_62k_job_free( sched_t *sched, void *job );
 int alg_2_62k_job_compare( sched_t *sched, void *joba, void *jobb );
 void alg_2_62k_inc_limit_job( sched_t *sched, void *job );
+graph_cost_t alg_2_62k_conflict( graph_value_t ab, graph_value_t ac, graph_value_t bc );
+double alg_2_62k_branchnumber( graph_value_t ab, graph_value_t ac, graph_value_t bc );
 
 sched_algorithm_t alg_2_62k = {
     alg_2_62k_calculate,
     alg_2_62k_job_free,
     alg_2_62k_job_compare,
-    alg_2_62k_inc_limit_job
+    alg_2_62k_inc_limit_job,
+    &graph_model_1_0
 };
 
 void alg_2_62k_calculate( sched_t *sched, void *job ) {
@@ -44,7 +50,7 @@ void alg_2_62k_calculate( sched_t *sched, void *job ) {
     graph_index_t a,b,c;
     graph_cost_t cost_left;
 
-    graphstate_lock( graphstate, 1, 0 );
+    graphstate_lock( graphstate, &graph_model_1_0 );
     cost_left = graphstate->cost_left;
     graphstate_unlock( graphstate );
     if( cost_left < 0 ) {
@@ -52,10 +58,11 @@ void alg_2_62k_calculate( sched_t *sched, void *job ) {
         return;
     }
 
-    graphstate = kernel_kernelize( graphstate, 1, 0 );
+    graphstate = kernel_kernelize( graphstate, &graph_model_1_0 );
+    graphstate = mincut_reduce( graphstate, &graph_model_1_0 );
 
     tmp = (graphstate_t *)sched_getBest( sched );
-    graphstate_lock( graphstate, 1, 0 );
+    graphstate_lock( graphstate, &graph_model_1_0 );
     if( graphstate->cost_left < 0 ) { /* If no cost is left, leave it */
         graphstate_unlock( graphstate );
         graphstate_decref( graphstate );
@@ -65,39 +72,23 @@ void alg_2_62k_calculate( sched_t *sched, void *job ) {
     if( graphstate->cost_left >= 0 && (tmp == NULL || graphstate->cost < tmp->cost ) ) {;
 
         g = graphstate->c.org->graph;
-        for( a = 0; a >= 0; a = graph_getNext( g, a ) ) {
-            for( b = graph_getNext( g, a ); b >= 0; b = graph_getNext( g, b ) ) {
-                if( graph_getValue( g,a,b ) <= 0 ) {
-                    for( c = 0; c >= 0; c = graph_getNext( g, c ) ) {
-                        if(     ( a!=c && b!=c ) && (
-                                (
-                                    ( graph_getValue( g, a, c ) >  0 ) &&
-                                    ( graph_getValue( g, b, c ) >= 0 )
-                                ) || (
-                                    ( graph_getValue( g, a, c ) >= 0 ) &&
-                                    ( graph_getValue( g, b, c ) >  0 )
-                                ) 
-                                ) ) {
-                            DBGLONG( 11, a );
-                            DBGLONG( 11, b );
-                            DBGLONG( 11, c );
-
-                            tmp = graphstate_create_chset( graphstate,
-                                    graph_merge( g, a, c ) );
-                            sched_job_add( sched, tmp );
-
-                            tmp = graphstate_create_chset( graphstate,
-                                    graph_setForbidden( g, a, c ) );
-                            sched_job_add( sched, tmp );
-
-                            DBGLONG( 11, graphstate->cost );
-
-                            goto alg_2_62k_dengo;
-                            /* TODO: Kill the velociraptor */
-                        }
-                    }
-                }
-            }
+        if( branch_getTriple( sched->branching, g, alg_2_62k_conflict, alg_2_62k_branchnumber, &a, &b, &c ) ) {
+            DBGLONG( 11, a );
+            DBGLONG( 11, b );
+            DBGLONG( 11, c );
+
+            tmp = graphstate_create_chset( graphstate,
+                    graph_merge( g, a, c ) );
+            sched_job_add( sched, tmp );
+
+            tmp = graphstate_create_chset( graphstate,
+                    graph_setForbidden( g, a, c ) );
+            sched_job_add( sched, tmp );
+
+            DBGLONG( 11, graphstate->cost );
+
+            goto alg_2_62k_dengo;
+            /* TODO: Kill the velociraptor */
         }
 
 
@@ -140,3 +131,21 @@ void alg_2_62k_inc_limit_job( sched_t *sched, void *job ) {
     graphstate_t *gs = (graphstate_t*)job;
     gs->cost_left += 1;
 }
+
+/* Conflict triple with the non-edge or zero-edge (a,b), where at most one
+ * of the other edges is a zero-edge
+ */
+graph_cost_t alg_2_62k_conflict( graph_value_t ab, graph_value_t ac, graph_value_t bc ) {
+    return ab <= 0 && ( ( ac > 0 && bc >= 0 ) || ( ac >= 0 && bc > 0 ) );
+}
+
+/* Branching number of the costs of merging and forbidding (a,c). Merging
+ * at least resolves the conflict with b.
+ */
+double alg_2_62k_branchnumber( graph_value_t ab, graph_value_t ac, graph_value_t bc ) {
+    graph_cost_t vec[2];
+
+    vec[0] = -ab < bc ? -ab : bc;
+    vec[1] = ac;
+    return branch_number( vec, 2 );
+}
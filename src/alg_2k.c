@@ -16,7 +16,6 @@
  * <http://www.gnu.org/licenses/>.
  */
 #include <stdio.h>
-#include <math.h>
 
 #include "debug.h"
 #include "sched.h"
@@ -26,36 +25,40 @@
 #include "graphstate.h"
 
 #include "kernel.h"
+#include "mincut.h"
+#include "pairsum.h"
+#include "branch.h"
 
 void alg_2k_calculate( sched_t *sched, void *job );
 void alg_2k_job_free( sched_t *sched, void *job );
 int alg_2k_job_compare( sched_t *sched, void *joba, void *jobb );
 void alg_2k_inc_limit_job( sched_t *sched, void *job );
-double alg_2k_calcbranch( graph_cost_t ac, graph_cost_t bc );
+graph_cost_t alg_2k_mergeterm( graph_value_t ab, graph_value_t ca, graph_value_t cb );
 
 sched_algorithm_t alg_2k = {
     alg_2k_calculate,
     alg_2k_job_free,
     alg_2k_job_compare,
-    alg_2k_inc_limit_job
+    alg_2k_inc_limit_job,
+    &graph_model_2_1
 };
 
 void alg_2k_calculate( sched_t *sched, void *job ) {
     graphstate_t *graphstate = (graphstate_t*)job;
     graphstate_t *tmp;
     graph_t *g;
-    graph_index_t a,b,c;
-    graph_cost_t ca, cb;
+    graph_index_t a,b;
     graph_cost_t cmerge, cforbid;
 
-    graph_cost_t *mergecost;
+    pairsum_t *mergesum;
     double branchvec;
     double branchvecmin;
+    graph_cost_t minmerge, minforbid;
     graph_index_t mina, minb;
 
     graph_cost_t cost_left;
 
-    graphstate_lock( graphstate, 2, 1 );
+    graphstate_lock( graphstate, &graph_model_2_1 );
     cost_left = graphstate->cost_left;
     graphstate_unlock( graphstate );
     if( cost_left < 0 ) {
@@ -63,10 +66,11 @@ void alg_2k_calculate( sched_t *sched, void *job ) {
         return;
     }
 
-   graphstate = kernel_kernelize( graphstate, 2, 1 );
+   graphstate = kernel_kernelize( graphstate, &graph_model_2_1 );
+    graphstate = mincut_reduce( graphstate, &graph_model_2_1 );
 
     tmp = (graphstate_t *)sched_getBest( sched );
-    graphstate_lock( graphstate, 2, 1 );
+    graphstate_lock( graphstate, &graph_model_2_1 );
     if( graphstate->cost_left < 0 ) { /* If no cost is left, leave it */
         graphstate_unlock( graphstate );
         graphstate_decref( graphstate );
@@ -79,72 +83,27 @@ void alg_2k_calculate( sched_t *sched, void *job ) {
 
         g = graphstate->c.org->graph;
 
-        /* TODO: no reallocation */
-        mergecost = fmem_alloc_arr( sizeof( graph_cost_t ), graph_getEdgeCount( g ) );
+        /* Merge costs are maintained incrementally on the graph */
+        mergesum = pairsum_get( g, alg_2k_mergeterm, NULL, 0 );
 
-        /* Initialize merge cost content */
+        /* Calculate branching vectors and select minimum*/
+        mina = -1;
+        minb = -1;
+        minmerge = 0;
+        minforbid = 0;
+        branchvecmin = 0.0;
         for( a = 0; a >= 0; a = graph_getNext( g, a ) ) {
             for( b = graph_getNext( g, a ); b >= 0; b = graph_getNext( g, b ) ) {
                 if( a != b ) {
                     cmerge = graph_getValue( g, a, b );
                     if( cmerge == 0 ) {
-                        mergecost[ GRAPH_EDGE_IDX( a, b ) ] = 1;
+                        cmerge = 1;
                     } else if( cmerge < 0 ) {
-                        mergecost[ GRAPH_EDGE_IDX( a, b ) ] = -cmerge*2;
+                        cmerge = -cmerge*2;
                     } else {
-                        mergecost[ GRAPH_EDGE_IDX( a, b ) ] = 0;
-                    }
-                }
-            }
-        }
-
-        /* Calculate merge costs in O(N^3) */
-
-        /* Iterate through all edges (a,b) */
-        for( a = 0; a >= 0; a = graph_getNext( g, a ) ) {
-            for( b = graph_getNext( g, a ); b >= 0; b = graph_getNext( g, b ) ) {
-                if( a != b ) {
-                    /* Iterate through all other nodes, c */
-                    for( c = 0; c >= 0; c = graph_getNext( g, c ) ) {
-                        if( a != c && b != c ) {
-                            /* Get costs of the edges (a,c) and (b,c) */
-                            ca = graph_getValue( g, a, c );
-                            cb = graph_getValue( g, b, c );
-
-
-                            /* Calculate cost for merging (a,c) and (b,c), and add to (a,b) */
-                            if( ca == 0 || cb == 0 ) {
-                                /* One edge is zero-edge = that edge is resolved
-                                 * Two edges is zero-edges = both edges is resolved, one new zerdo-edge is created
-                                 * Both cases means one zero-edge is removed...
-                                 */
-                                mergecost[ GRAPH_EDGE_IDX( a, b ) ] += 1; /* Cost for resolving a zeroedge */
-                                DBGPRINT( 19, "Zeroedge" );
-                            }
-
-                            if( ((ca<0) && (cb>0)) || ((ca>0) && (cb<0)) ) {
-                                if( ca < 0 ) {
-                                    ca = -ca;
-                                }
-                                if( cb < 0 ) {
-                                    cb = -cb;
-                                }
-                                cmerge = (ca>cb) ? (cb) : (ca);
-
-                                mergecost[ GRAPH_EDGE_IDX( a, b ) ] += cmerge*2;
-                            }
-                        }
+                        cmerge = 0;
                     }
-                }
-            }
-        }
-
-        /* Calculate branching vectors and select minimum*/
-        mina = -1;
-        for( a = 0; a >= 0; a = graph_getNext( g, a ) ) {
-            for( b = graph_getNext( g, a ); b >= 0; b = graph_getNext( g, b ) ) {
-                if( a != b ) {
-                    cmerge = mergecost[ GRAPH_EDGE_IDX( a, b ) ];
+                    cmerge += pairsum_getValue( mergesum, a, b );
                     /* TODO: cmerge == 0 means infinite branching vector; no branching */
                     if( cmerge > 0 ) {
                         cforbid = graph_getValue( g, a, b )*2;
@@ -154,12 +113,21 @@ void alg_2k_calculate( sched_t *sched, void *job ) {
                                 cforbid += 1;
                             }
 
-                            branchvec = alg_2k_calcbranch( cmerge, cforbid );
+                            /* A vector no larger in both directions than the
+                             * best one can't have a smaller branching number
+                             */
+                            if( mina >= 0 && cmerge <= minmerge && cforbid <= minforbid ) {
+                                continue;
+                            }
+
+                            branchvec = branch_number2( cmerge, cforbid );
 
                             DBGDOUBLE( 19, branchvec );
 
                             if( mina < 0 || branchvecmin > branchvec ) {
                                 branchvecmin = branchvec;
+                                minmerge = cmerge;
+                                minforbid = cforbid;
                                 mina = a;
                                 minb = b;
                             }
@@ -182,8 +150,6 @@ void alg_2k_calculate( sched_t *sched, void *job ) {
         }
 
 
-        fmem_free( mergecost );
-
     } else {
 
         DBGPRINT( 11, "Worse than best" );
@@ -210,31 +176,31 @@ void alg_2k_inc_limit_job( sched_t *sched, void *job ) {
     gs->cost_left += 2;
 }
 
-double alg_2k_calcbranch( graph_cost_t ac, graph_cost_t bc ) {
-    double max, min;
-    double z, y, d, a, b;
-    double powzmax, powzmin;
-    a = ac/2.0;
-    b = bc/2.0;
+/* Cost for merging (a,c) and (b,c), added to the merge cost of (a,b).
+ * Doesn't depend on (a,b), which is taken as a pairsum_term_t.
+ */
+graph_cost_t alg_2k_mergeterm( graph_value_t ab, graph_value_t ca, graph_value_t cb ) {
+    graph_cost_t cost = 0;
 
-    if( a > b ) {
-        max = a;
-        min = a-b;
-    } else {
-        max = b;
-        min = b-a;
-    }
+    (void)ab;
 
-    z = 2.0;
+    if( ca == 0 || cb == 0 ) {
+        /* One edge is zero-edge = that edge is resolved
+         * Two edges is zero-edges = both edges is resolved, one new zerdo-edge is created
+         * Both cases means one zero-edge is removed...
+         */
+        cost += 1; /* Cost for resolving a zeroedge */
+    }
 
-    do {
-        powzmax = pow( z, max );
-        powzmin = pow( z, min );
-        d = powzmax*max/z - powzmin*min/z;
-        y = powzmax - powzmin - 1;
-        d = y/d;
-        z -= d;
-    } while( d*d > 0.00001 );
+    if( ((ca<0) && (cb>0)) || ((ca>0) && (cb<0)) ) {
+        if( ca < 0 ) {
+            ca = -ca;
+        }
+        if( cb < 0 ) {
+            cb = -cb;
+        }
+        cost += ((ca>cb) ? (cb) : (ca))*2;
+    }
 
-    return z;
+    return cost;
 }
@@ -24,17 +24,24 @@
 #include "graphstate.h"
 
 #include "kernel.h"
+#include "mincut.h"
+#include "pairsum.h"
+#include "branch.h"
 
 void alg_3k_calculate( sched_t *sched, void *job );
 void alg_3k_job_free( sched_t *sched, void *job );
 int alg_3k_job_compare( sched_t *sched, void *joba, void *jobb );
 void alg_3k_inc_limit_job( sched_t *sched, void *job );
+graph_cost_t alg_3k_conflict( graph_value_t ab, graph_value_t ac, graph_value_t bc );
+double alg_3k_branchnumber( graph_value_t ab, graph_value_t ac, graph_value_t bc );
+graphstate_t *alg_3k_decide( graphstate_t *gs, const graph_t *g, graph_index_t a, graph_index_t b, graph_value_t value );
 
 sched_algorithm_t alg_3k = {
     alg_3k_calculate,
     alg_3k_job_free,
     alg_3k_job_compare,
-    alg_3k_inc_limit_job
+    alg_3k_inc_limit_job,
+    &graph_model_1_0
 };
 
 void alg_3k_calculate( sched_t *sched, void *job ) {
@@ -45,9 +52,10 @@ void alg_3k_calculate( sched_t *sched, void *job ) {
 
     graph_cost_t cost_left;
 
-    graphstate = kernel_kernelize( graphstate, 2, 1 );
+    graphstate = kernel_kernelize( graphstate, &graph_model_1_0 );
+    graphstate = mincut_reduce( graphstate, &graph_model_1_0 );
 
-    graphstate_lock( graphstate, 1, 0 );
+    graphstate_lock( graphstate, &graph_model_1_0 );
     cost_left = graphstate->cost_left;
     graphstate_unlock( graphstate );
     if( cost_left < 0 ) {
@@ -56,7 +64,7 @@ void alg_3k_calculate( sched_t *sched, void *job ) {
     }
 
     tmp = (graphstate_t *)sched_getBest( sched );
-    graphstate_lock( graphstate, 1, 0 );
+    graphstate_lock( graphstate, &graph_model_1_0 );
     if( graphstate->cost_left < 0 ) { /* If no cost is left, leave it */
         graphstate_unlock( graphstate );
         graphstate_decref( graphstate );
@@ -66,38 +74,45 @@ void alg_3k_calculate( sched_t *sched, void *job ) {
     if( graphstate->cost_left >= 0 && ( tmp == NULL || graphstate->cost < tmp->cost ) ) {
 
         g = graphstate->c.org->graph;
-        for( a = 0; a >= 0; a = graph_getNext( g, a ) ) {
-            for( b = graph_getNext( g, a ); b >= 0; b = graph_getNext( g, b ) ) {
-                if( graph_getValue( g,a,b ) < 0 ) {
-                    for( c = 0; c >= 0; c = graph_getNext( g, c ) ) {
-                        if(     ( a!=c && b!=c ) &&
-                                ( graph_getValue( g, a, c ) > 0 ) &&
-                                ( graph_getValue( g, b, c ) > 0 ) ) {
-                            DBGLONG( 11, a );
-                            DBGLONG( 11, b );
-                            DBGLONG( 11, c );
-
-                            tmp = graphstate_create_chset( graphstate,
-                                    graph_setPersistant( g, a, b ) );
-                            sched_job_add( sched, tmp );
-
-                            tmp = graphstate_create_chset( graphstate,
-                                    graph_setForbidden( g, a, c ) );
-                            sched_job_add( sched, tmp );
-
-                            tmp = graphstate_create_chset( graphstate,
-                                    graph_setForbidden( g, b, c ) );
-                            sched_job_add( sched, tmp );
-
-
-                            DBGLONG( 11, graphstate->cost );
-
-                            goto alg_3k_dengo;
-                            /* TODO: Kill the velociraptor */
-                        }
-                    }
-                }
+        if( branch_getTriple( sched->branching, g, alg_3k_conflict, alg_3k_branchnumber, &a, &b, &c ) ) {
+            DBGLONG( 11, a );
+            DBGLONG( 11, b );
+            DBGLONG( 11, c );
+
+            /* The branches are made disjoint by deciding the edges of
+             * the earlier branches the other way in the later ones.
+             * Branches that would change an already decided edge are
+             * skipped.
+             */
+
+            /* (a,b) together */
+            if( !GRAPH_ISFORBIDDEN( graph_getValue( g, a, b ) ) ) {
+                tmp = graphstate_create_chset( graphstate,
+                        graph_setPersistant( g, a, b ) );
+                sched_job_add( sched, tmp );
             }
+
+            /* (a,b) apart, (a,c) apart */
+            if( !GRAPH_ISPERSISTANT( graph_getValue( g, a, c ) ) ) {
+                graphstate_incref( graphstate );
+                tmp = alg_3k_decide( graphstate, g, a, b, GRAPH_VALUE_FORBIDDEN );
+                tmp = alg_3k_decide( tmp, g, a, c, GRAPH_VALUE_FORBIDDEN );
+                sched_job_add( sched, tmp );
+            }
+
+            /* (a,b) apart, (a,c) together, (b,c) apart */
+            if( !GRAPH_ISPERSISTANT( graph_getValue( g, b, c ) ) ) {
+                graphstate_incref( graphstate );
+                tmp = alg_3k_decide( graphstate, g, a, b, GRAPH_VALUE_FORBIDDEN );
+                tmp = alg_3k_decide( tmp, g, a, c, GRAPH_VALUE_PERSISTANT );
+                tmp = alg_3k_decide( tmp, g, b, c, GRAPH_VALUE_FORBIDDEN );
+                sched_job_add( sched, tmp );
+            }
+
+            DBGLONG( 11, graphstate->cost );
+
+            goto alg_3k_dengo;
+            /* TODO: Kill the velociraptor */
         }
 
 
@@ -140,3 +155,41 @@ void alg_3k_inc_limit_job( sched_t *sched, void *job ) {
     graphstate_t *gs = (graphstate_t*)job;
     gs->cost_left += 1;
 }
+
+/* Conflict triple with the non-edge (a,b) */
+graph_cost_t alg_3k_conflict( graph_value_t ab, graph_value_t ac, graph_value_t bc ) {
+    return ab < 0 && ac > 0 && bc > 0;
+}
+
+/* Branching number of the costs of setting (a,b) persistant, and
+ * forbidding (a,c) and (b,c)
+ */
+double alg_3k_branchnumber( graph_value_t ab, graph_value_t ac, graph_value_t bc ) {
+    graph_cost_t vec[3];
+
+    vec[0] = -ab;
+    vec[1] = ac;
+    vec[2] = bc;
+    return branch_number( vec, 3 );
+}
+
+/* Set the edge (a,b) forbidden or persistant, unless already decided.
+ * Takes over the reference to gs, and returns a reference to the new state.
+ */
+graphstate_t *alg_3k_decide( graphstate_t *gs, const graph_t *g, graph_index_t a, graph_index_t b, graph_value_t value ) {
+    graphstate_t *newgs;
+    graph_value_t old;
+
+    old = graph_getValue( g, a, b );
+    if( GRAPH_ISFORBIDDEN( old ) || GRAPH_ISPERSISTANT( old ) ) {
+        return gs;
+    }
+
+    if( value == GRAPH_VALUE_FORBIDDEN ) {
+        newgs = graphstate_create_chset( gs, graph_setForbidden( g, a, b ) );
+    } else {
+        newgs = graphstate_create_chset( gs, graph_setPersistant( g, a, b ) );
+    }
+    graphstate_decref( gs );
+    return newgs;
+}
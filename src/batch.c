@@ -0,0 +1,199 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <pthread.h>
+
+#include "debug.h"
+#include "graph.h"
+#include "sched.h"
+#include "datasource.h"
+#include "solve.h"
+#include "fmem.h"
+#include "batch.h"
+
+#ifndef BATCH_THREADS_DEFAULT
+#define BATCH_THREADS_DEFAULT 4
+#endif
+
+#define BATCH_THREADS_MAX 64
+
+/* Instances read ahead per thread, bounding the graphs held in memory */
+#define BATCH_AHEAD 2
+
+/* An instance, in a ring of slots indexed by read order */
+typedef struct batch_job_t {
+    graph_t         *graph;
+    graph_index_t   *cliqueid;
+    graph_cost_t    cost;
+    int             done;
+} batch_job_t;
+
+typedef struct batch_pool_t {
+    const solve_t   *settings;
+    batch_job_t     *job;
+    long            slots;
+    long            shown;      /* Instances before this are shown */
+    long            taken;      /* and before this taken by a thread */
+    long            read;       /* and before this read */
+    int             quit;
+    pthread_mutex_t lock;
+    pthread_cond_t  work;       /* Signaled when read or quit changes */
+    pthread_cond_t  done;       /* Signaled when a job is done */
+} batch_pool_t;
+
+static int batch_threads = BATCH_THREADS_DEFAULT;
+
+void batch_solve( batch_pool_t *pool, sched_t *sched, batch_job_t *job );
+void *batch_worker( void *arg );
+
+void batch_setThreads( int threads ) {
+    ASSERT( threads > 0 );
+    batch_threads = threads < BATCH_THREADS_MAX ? threads : BATCH_THREADS_MAX;
+}
+
+void batch_solve( batch_pool_t *pool, sched_t *sched, batch_job_t *job ) {
+    job->cliqueid = fmem_alloc_arr( sizeof( graph_index_t ), graph_getNodeCount( job->graph ) + 1 );
+    job->cost = solve_graph( sched, pool->settings, job->graph, 0, job->cliqueid );
+}
+
+void *batch_worker( void *arg ) {
+    batch_pool_t *pool = (batch_pool_t *)arg;
+    batch_job_t *job;
+    sched_t *sched;
+
+    sched = solve_createSched( pool->settings );
+
+    pthread_mutex_lock( &pool->lock );
+    for(;;) {
+        while( pool->taken == pool->read && !pool->quit ) {
+            pthread_cond_wait( &pool->work, &pool->lock );
+        }
+        if( pool->taken == pool->read ) {
+            break;
+        }
+        job = &pool->job[pool->taken++ % pool->slots];
+        pthread_mutex_unlock( &pool->lock );
+
+        batch_solve( pool, sched, job );
+
+        pthread_mutex_lock( &pool->lock );
+        job->done = 1;
+        pthread_cond_broadcast( &pool->done );
+    }
+    pthread_mutex_unlock( &pool->lock );
+
+    sched_free( sched );
+    return NULL;
+}
+
+void batch_run( datasource_storage_t *ds, const solve_t *settings ) {
+    pthread_t thread[BATCH_THREADS_MAX];
+    batch_pool_t pool;
+    batch_job_t *job;
+    sched_t *sched;
+    graph_t *graph;
+    int t, started, more;
+
+    pool.settings = settings;
+    pool.slots = BATCH_AHEAD * batch_threads;
+    pool.job = fmem_alloc_arr( sizeof( batch_job_t ), pool.slots );
+    pool.shown = 0;
+    pool.taken = 0;
+    pool.read = 0;
+    pool.quit = 0;
+    pthread_mutex_init( &pool.lock, NULL );
+    pthread_cond_init( &pool.work, NULL );
+    pthread_cond_init( &pool.done, NULL );
+
+    started = 0;
+    for( t = 0; t < batch_threads; t++ ) {
+        if( pthread_create( &thread[started], NULL, batch_worker, &pool ) == 0 ) {
+            started++;
+        }
+    }
+
+    /* Without threads, solve each instance as it is read */
+    sched = NULL;
+    if( started == 0 ) {
+        sched = solve_createSched( settings );
+    }
+
+    more = 1;
+    for(;;) {
+        /* Read while there are free slots, then show the oldest instance */
+        if( more && pool.read - pool.shown < pool.slots ) {
+            graph = datasource_get( ds );
+            if( graph == NULL ) {
+                more = 0;
+                continue;
+            }
+            job = &pool.job[pool.read % pool.slots];
+            job->graph = graph;
+            job->cliqueid = NULL;
+            job->done = 0;
+            if( sched != NULL ) {
+                batch_solve( &pool, sched, job );
+                job->done = 1;
+                pool.taken++;
+            }
+
+            pthread_mutex_lock( &pool.lock );
+            pool.read++;
+            pthread_cond_signal( &pool.work );
+            pthread_mutex_unlock( &pool.lock );
+            continue;
+        }
+        if( pool.shown == pool.read ) {
+            break;
+        }
+
+        job = &pool.job[pool.shown % pool.slots];
+        pthread_mutex_lock( &pool.lock );
+        while( !job->done ) {
+            pthread_cond_wait( &pool.done, &pool.lock );
+        }
+        pthread_mutex_unlock( &pool.lock );
+
+        /* Unsolved instances are shown too, to keep the names in order */
+        if( job->cost == SOLVE_TOO_LARGE ) {
+            fprintf( stderr, "Instance %ld: %ld nodes too large to solve in the sparse layout, at most %d\n",
+                    pool.shown + 1, (long)graph_getNodeCount( job->graph ), SOLVE_SPARSE_NODES_MAX );
+            datasource_show( ds, job->graph, NULL );
+        } else {
+            datasource_show( ds, job->graph, job->cliqueid );
+        }
+        fmem_free( job->cliqueid );
+        graph_free( job->graph );
+        pool.shown++;
+    }
+
+    pthread_mutex_lock( &pool.lock );
+    pool.quit = 1;
+    pthread_cond_broadcast( &pool.work );
+    pthread_mutex_unlock( &pool.lock );
+    for( t = 0; t < started; t++ ) {
+        pthread_join( thread[t], NULL );
+    }
+
+    if( sched != NULL ) {
+        sched_free( sched );
+    }
+    pthread_cond_destroy( &pool.work );
+    pthread_cond_destroy( &pool.done );
+    pthread_mutex_destroy( &pool.lock );
+    fmem_free( pool.job );
+}
@@ -0,0 +1,33 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "datasource.h"
+#include "solve.h"
+
+/* Number of threads solving instances */
+void batch_setThreads( int threads );
+
+/* Solve all graphs from ds on a pool of threads, each with its own
+ * scheduler. The results are shown with datasource_show in the order the
+ * graphs were read, by the calling thread, which also reads the graphs.
+ */
+void batch_run( datasource_storage_t *ds, const solve_t *settings );
+
+#endif
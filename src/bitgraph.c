@@ -0,0 +1,513 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "debug.h"
+#include "graph.h"
+#include "fmem.h"
+#include "solve.h"
+#include "bitgraph.h"
+
+/* Bitset based branch and bound for small graphs.
+ *
+ * Every row of the graph is a 64 bit mask. A search node is described by
+ * two masks per node: pairs decided to be in the same cluster (permanent),
+ * and pairs decided to be in different clusters (forbidden). Both
+ * relations are kept closed, so permanent rows always describe cliques.
+ *
+ * The effective graph of a search node is the permanent pairs together
+ * with the undecided positive pairs. Conflict triples of the effective
+ * graph are found as (eff[u] ^ eff[v]), and every branch decides at least
+ * one undecided pair, so the search depth is bounded by the pair count.
+ *
+ * The search is depth first on a stack of search nodes on the heap. A
+ * recursion could reach 2016 levels of a few kilobytes each, too deep for
+ * the stacks of the batch and server threads.
+ */
+
+typedef uint64_t bitgraph_mask_t;
+
+#define BITGRAPH_BIT( _N ) ( ((bitgraph_mask_t)1) << (_N) )
+
+/* Mask of all nodes with higher index than _N */
+#define BITGRAPH_ABOVE( _N ) ( ~( ( BITGRAPH_BIT( _N ) << 1 ) - 1 ) )
+
+/* Search nodes between looks at the clock */
+#define BITGRAPH_CHECK_STEPS 64
+
+#if defined(__GNUC__)
+#define BITGRAPH_CTZ( _X )      __builtin_ctzll( _X )
+#define BITGRAPH_POPCOUNT( _X ) __builtin_popcountll( _X )
+#else
+#define BITGRAPH_CTZ( _X )      bitgraph_ctz( _X )
+#define BITGRAPH_POPCOUNT( _X ) bitgraph_popcount( _X )
+#endif
+
+typedef struct bitgraph_state_t {
+    bitgraph_mask_t perm[BITGRAPH_MAX_NODES];
+    bitgraph_mask_t forb[BITGRAPH_MAX_NODES];
+} bitgraph_state_t;
+
+/* A search node waiting on the stack */
+typedef struct bitgraph_frame_t {
+    bitgraph_state_t    st;
+    graph_cost_t        cost;
+} bitgraph_frame_t;
+
+typedef struct bitgraph_t {
+    int             nodes;
+    graph_value_t   weight[BITGRAPH_MAX_NODES][BITGRAPH_MAX_NODES];
+    bitgraph_mask_t pos[BITGRAPH_MAX_NODES];    /* Positive pairs in input */
+
+    graph_cost_t    best;                       /* Best solution so far */
+    graph_index_t   *bestid;
+
+    bitgraph_frame_t *stack;                    /* Room for a frame per pair, and one */
+    long            top;
+
+    double          deadline;                   /* As from solve_now, 0 for none */
+    long            steps;
+    int             timeout;
+
+    long            searched;                   /* Search nodes expanded, for all limits */
+} bitgraph_t;
+
+int bitgraph_ctz( bitgraph_mask_t x );
+int bitgraph_popcount( bitgraph_mask_t x );
+graph_cost_t bitgraph_flipcost( const bitgraph_t *bg, const bitgraph_state_t *st, int a, int b );
+int bitgraph_join( const bitgraph_t *bg, bitgraph_state_t *st, int u, int v, graph_cost_t *cost );
+int bitgraph_forbid( const bitgraph_t *bg, bitgraph_state_t *st, int u, int v, graph_cost_t *cost );
+void bitgraph_record( bitgraph_t *bg, const bitgraph_mask_t *eff, graph_cost_t cost );
+void bitgraph_push( bitgraph_t *bg, const bitgraph_state_t *st, graph_cost_t cost, int p, int q, int join );
+void bitgraph_expand( bitgraph_t *bg, const bitgraph_frame_t *frame );
+void bitgraph_search( bitgraph_t *bg, const bitgraph_state_t *st );
+
+int bitgraph_ctz( bitgraph_mask_t x ) {
+    int i = 0;
+    while( !( x & 1 ) ) {
+        x >>= 1;
+        i++;
+    }
+    return i;
+}
+
+int bitgraph_popcount( bitgraph_mask_t x ) {
+    int i = 0;
+    for( ; x; x &= x-1 ) {
+        i++;
+    }
+    return i;
+}
+
+/* Cost to change the current sign of an undecided pair, -1 when decided */
+graph_cost_t bitgraph_flipcost( const bitgraph_t *bg, const bitgraph_state_t *st, int a, int b ) {
+    graph_value_t w;
+    if( ( st->perm[a] | st->forb[a] ) & BITGRAPH_BIT( b ) ) {
+        return -1;
+    }
+    w = bg->weight[a][b];
+    return w < 0 ? -w : w;
+}
+
+/* Put the clusters of u and v together. Forbidden pairs of one cluster
+ * are inherited by the other. Returns 0 if the clusters are forbidden to
+ * be joined.
+ */
+int bitgraph_join( const bitgraph_t *bg, bitgraph_state_t *st, int u, int v, graph_cost_t *cost ) {
+    bitgraph_mask_t A, B, FA, FB, m, x;
+    graph_value_t w;
+    int a, b;
+
+    A = st->perm[u] | BITGRAPH_BIT( u );
+    B = st->perm[v] | BITGRAPH_BIT( v );
+    if( A & B ) {
+        return 1;
+    }
+
+    FA = 0;
+    for( m = A; m; m &= m-1 ) {
+        a = BITGRAPH_CTZ( m );
+        if( st->forb[a] & B ) {
+            return 0;
+        }
+        FA |= st->forb[a];
+    }
+    FB = 0;
+    for( m = B; m; m &= m-1 ) {
+        FB |= st->forb[BITGRAPH_CTZ( m )];
+    }
+
+    for( m = A; m; m &= m-1 ) {
+        a = BITGRAPH_CTZ( m );
+        /* Nonedges inside the new cluster */
+        for( x = B; x; x &= x-1 ) {
+            w = bg->weight[a][BITGRAPH_CTZ( x )];
+            if( w < 0 ) {
+                *cost -= w;
+            }
+        }
+        /* Edges to nodes forbidden from the other cluster */
+        for( x = FB & ~st->forb[a]; x; x &= x-1 ) {
+            w = bg->weight[a][BITGRAPH_CTZ( x )];
+            if( w > 0 ) {
+                *cost += w;
+            }
+        }
+    }
+    for( m = B; m; m &= m-1 ) {
+        b = BITGRAPH_CTZ( m );
+        for( x = FA & ~st->forb[b]; x; x &= x-1 ) {
+            w = bg->weight[b][BITGRAPH_CTZ( x )];
+            if( w > 0 ) {
+                *cost += w;
+            }
+        }
+    }
+
+    for( m = A; m; m &= m-1 ) {
+        a = BITGRAPH_CTZ( m );
+        st->perm[a] |= B;
+        st->forb[a] |= FB;
+    }
+    for( m = B; m; m &= m-1 ) {
+        b = BITGRAPH_CTZ( m );
+        st->perm[b] |= A;
+        st->forb[b] |= FA;
+    }
+    for( m = FB; m; m &= m-1 ) {
+        st->forb[BITGRAPH_CTZ( m )] |= A;
+    }
+    for( m = FA; m; m &= m-1 ) {
+        st->forb[BITGRAPH_CTZ( m )] |= B;
+    }
+    return 1;
+}
+
+/* Forbid the clusters of u and v to be joined. Returns 0 if they already
+ * are the same cluster.
+ */
+int bitgraph_forbid( const bitgraph_t *bg, bitgraph_state_t *st, int u, int v, graph_cost_t *cost ) {
+    bitgraph_mask_t A, B, m, x;
+    graph_value_t w;
+    int a;
+
+    A = st->perm[u] | BITGRAPH_BIT( u );
+    B = st->perm[v] | BITGRAPH_BIT( v );
+    if( A & B ) {
+        return 0;
+    }
+
+    for( m = A; m; m &= m-1 ) {
+        a = BITGRAPH_CTZ( m );
+        for( x = B & ~st->forb[a]; x; x &= x-1 ) {
+            w = bg->weight[a][BITGRAPH_CTZ( x )];
+            if( w > 0 ) {
+                *cost += w;
+            }
+        }
+        st->forb[a] |= B;
+    }
+    for( m = B; m; m &= m-1 ) {
+        st->forb[BITGRAPH_CTZ( m )] |= A;
+    }
+    return 1;
+}
+
+/* The effective graph is a cluster graph, save it as best */
+void bitgraph_record( bitgraph_t *bg, const bitgraph_mask_t *eff, graph_cost_t cost ) {
+    bitgraph_mask_t done, m;
+    graph_index_t c_id;
+    int u;
+
+    DBGLONG( 11, cost );
+
+    bg->best = cost;
+    done = 0;
+    c_id = 0;
+    for( u = 0; u < bg->nodes; u++ ) {
+        if( !( done & BITGRAPH_BIT( u ) ) ) {
+            bg->bestid[u] = c_id;
+            for( m = eff[u]; m; m &= m-1 ) {
+                bg->bestid[BITGRAPH_CTZ( m )] = c_id;
+            }
+            done |= eff[u] | BITGRAPH_BIT( u );
+            c_id++;
+        }
+    }
+}
+
+/* Push the search node of st with p and q joined or forbidden, unless that
+ * is impossible
+ */
+void bitgraph_push( bitgraph_t *bg, const bitgraph_state_t *st, graph_cost_t cost, int p, int q, int join ) {
+    bitgraph_frame_t *child;
+    int ok;
+
+    child = &bg->stack[bg->top];
+    child->st = *st;
+    child->cost = cost;
+    if( join ) {
+        ok = bitgraph_join( bg, &child->st, p, q, &child->cost );
+    } else {
+        ok = bitgraph_forbid( bg, &child->st, p, q, &child->cost );
+    }
+    if( ok ) {
+        bg->top++;
+    }
+}
+
+/* Apply the forced decisions of a search node, and record it as a solution
+ * or push its branches
+ */
+void bitgraph_expand( bitgraph_t *bg, const bitgraph_frame_t *frame ) {
+    bitgraph_state_t cur;
+    bitgraph_mask_t eff[BITGRAPH_MAX_NODES];
+    bitgraph_mask_t used[BITGRAPH_MAX_NODES];
+    bitgraph_mask_t m, X, common, diff;
+    graph_cost_t cost, bound, c, c2, budget;
+    graph_cost_t icf, icp, branchval;
+    graph_value_t w;
+    int u, v, x, n;
+    int p, q, forced;
+
+    n = bg->nodes;
+    cur = frame->st;
+    cost = frame->cost;
+
+    /* Apply forced decisions until stable, then branch */
+    do {
+        if( cost >= bg->best ) {
+            return;
+        }
+        budget = bg->best - cost - 1;
+
+        for( u = 0; u < n; u++ ) {
+            eff[u] = cur.perm[u] | ( bg->pos[u] & ~cur.forb[u] );
+            used[u] = 0;
+        }
+
+        /* For every undecided pair in a conflict triple, calculate the
+         * induced cost of forbidding (icf) and of clustering (icp) it.
+         * A pair whose induced cost exceeds the budget is forced, else the
+         * pair with highest minimum induced cost is selected for branching.
+         */
+        forced = 0;
+        bound = 0;
+        branchval = -1;
+        p = q = -1;
+        for( u = 0; u < n && !forced; u++ ) {
+            for( m = ~( cur.perm[u] | cur.forb[u] ) & BITGRAPH_ABOVE( u ); m; m &= m-1 ) {
+                v = BITGRAPH_CTZ( m );
+                if( v >= n ) {
+                    break;
+                }
+                common = eff[u] & eff[v];
+                diff = ( eff[u] ^ eff[v] ) & ~( BITGRAPH_BIT( u ) | BITGRAPH_BIT( v ) );
+
+                w = bg->weight[u][v];
+                if( ( eff[u] & BITGRAPH_BIT( v ) ) ? !diff : !common ) {
+                    continue; /* Not part of a conflict */
+                }
+
+                icf = w > 0 ? w : 0;
+                for( X = common; X && icf <= budget; X &= X-1 ) {
+                    x = BITGRAPH_CTZ( X );
+                    c = bitgraph_flipcost( bg, &cur, u, x );
+                    c2 = bitgraph_flipcost( bg, &cur, v, x );
+                    if( c < 0 || ( c2 >= 0 && c2 < c ) ) c = c2;
+                    icf += c < 0 ? budget + 1 : c;
+                }
+                icp = w < 0 ? -w : 0;
+                for( X = diff; X && icp <= budget; X &= X-1 ) {
+                    x = BITGRAPH_CTZ( X );
+                    c = bitgraph_flipcost( bg, &cur, u, x );
+                    c2 = bitgraph_flipcost( bg, &cur, v, x );
+                    if( c < 0 || ( c2 >= 0 && c2 < c ) ) c = c2;
+                    icp += c < 0 ? budget + 1 : c;
+                }
+
+                if( icf > budget && icp > budget ) {
+                    return;
+                } else if( icf > budget ) {
+                    if( !bitgraph_join( bg, &cur, u, v, &cost ) ) {
+                        return;
+                    }
+                    forced = 1;
+                    break;
+                } else if( icp > budget ) {
+                    if( !bitgraph_forbid( bg, &cur, u, v, &cost ) ) {
+                        return;
+                    }
+                    forced = 1;
+                    break;
+                }
+
+                c = icf < icp ? icf : icp;
+                if( c > branchval ) {
+                    branchval = c;
+                    p = u;
+                    q = v;
+                }
+            }
+        }
+    } while( forced );
+
+    if( p < 0 ) {
+        /* No conflicts left */
+        bitgraph_record( bg, eff, cost );
+        return;
+    }
+
+    /* Bound the cost by a packing of pair disjoint conflict triples */
+    for( u = 0; u < n; u++ ) {
+        for( m = eff[u] & BITGRAPH_ABOVE( u ); m; m &= m-1 ) {
+            v = BITGRAPH_CTZ( m );
+            if( used[u] & BITGRAPH_BIT( v ) ) {
+                continue;
+            }
+            X = ( eff[u] ^ eff[v] ) & ~( BITGRAPH_BIT( u ) | BITGRAPH_BIT( v ) );
+            for( X &= ~( used[u] | used[v] ); X; X &= X-1 ) {
+                x = BITGRAPH_CTZ( X );
+                c = bitgraph_flipcost( bg, &cur, u, v );
+                c2 = bitgraph_flipcost( bg, &cur, u, x );
+                if( c < 0 || ( c2 >= 0 && c2 < c ) ) c = c2;
+                c2 = bitgraph_flipcost( bg, &cur, v, x );
+                if( c < 0 || ( c2 >= 0 && c2 < c ) ) c = c2;
+                if( c > 0 ) {
+                    bound += c;
+                    used[u] |= BITGRAPH_BIT( v ) | BITGRAPH_BIT( x );
+                    used[v] |= BITGRAPH_BIT( u ) | BITGRAPH_BIT( x );
+                    used[x] |= BITGRAPH_BIT( u ) | BITGRAPH_BIT( v );
+                    break;
+                }
+            }
+        }
+    }
+    if( cost + bound >= bg->best ) {
+        return;
+    }
+
+    /* Keep the current sign in the first branch, which is pushed last */
+    if( bg->pos[p] & BITGRAPH_BIT( q ) ) {
+        bitgraph_push( bg, &cur, cost, p, q, 0 );
+        bitgraph_push( bg, &cur, cost, p, q, 1 );
+    } else {
+        bitgraph_push( bg, &cur, cost, p, q, 1 );
+        bitgraph_push( bg, &cur, cost, p, q, 0 );
+    }
+}
+
+/* Depth first search from st. Every search node decides at least one pair
+ * more than its parent, and pushes at most two, so the stack holds at most
+ * a node per pair, and one.
+ */
+void bitgraph_search( bitgraph_t *bg, const bitgraph_state_t *st ) {
+    bitgraph_frame_t frame;
+
+    bg->stack[0].st = *st;
+    bg->stack[0].cost = 0;
+    bg->top = 1;
+    while( bg->top > 0 ) {
+        if( bg->deadline > 0 && ++bg->steps % BITGRAPH_CHECK_STEPS == 0 && solve_now() > bg->deadline ) {
+            bg->timeout = 1;
+            return;
+        }
+        bg->top--;
+        bg->searched++;
+        frame = bg->stack[bg->top];
+        bitgraph_expand( bg, &frame );
+    }
+}
+
+graph_cost_t bitgraph_solve( const graph_t *graph, const graph_model_t *model, double deadline, graph_index_t *cliqueid, long *searched ) {
+    bitgraph_t bg;
+    bitgraph_state_t st;
+    graph_value_t w;
+    graph_cost_t sumpos, limit, zeros;
+    int u, v;
+
+    ASSERT( graph_getNodeCount( graph ) <= BITGRAPH_MAX_NODES );
+
+    bg.nodes = graph_getNodeCount( graph );
+    bg.bestid = cliqueid;
+    bg.deadline = deadline;
+    bg.steps = 0;
+    bg.timeout = 0;
+    bg.searched = 0;
+    bg.stack = fmem_alloc_arr( sizeof( bitgraph_frame_t ), bg.nodes*( bg.nodes - 1 )/2 + 1 );
+
+    sumpos = 0;
+    zeros = 0;
+    for( u = 0; u < bg.nodes; u++ ) {
+        bg.pos[u] = 0;
+        st.perm[u] = 0;
+        st.forb[u] = 0;
+    }
+    for( u = 0; u < bg.nodes; u++ ) {
+        for( v = u+1; v < bg.nodes; v++ ) {
+            w = graph_getValue( graph, u, v );
+            bg.weight[u][v] = w;
+            bg.weight[v][u] = w;
+            if( w > 0 ) {
+                bg.pos[u] |= BITGRAPH_BIT( v );
+                bg.pos[v] |= BITGRAPH_BIT( u );
+                sumpos += w;
+            } else if( w == 0 ) {
+                zeros++;
+            }
+        }
+    }
+
+    /* Iterative deepening on the cost limit; a tight limit lets the
+     * induced cost rules force most decisions. Every node in a cluster of
+     * its own is always a solution, of cost sumpos.
+     */
+    limit = 0;
+    for(;;) {
+        if( limit >= sumpos ) {
+            bg.best = sumpos;
+            for( u = 0; u < bg.nodes; u++ ) {
+                cliqueid[u] = u;
+            }
+        } else {
+            bg.best = limit + 1;
+        }
+
+        DBGLONG( 10, limit );
+        bitgraph_search( &bg, &st );
+
+        if( bg.timeout || bg.best <= limit || limit >= sumpos ) {
+            break;
+        }
+        limit += 1 + limit/4;
+    }
+
+    DBGLONG( 5, bg.best );
+    DBGLONG( 5, bg.searched );
+    fmem_free( bg.stack );
+    if( searched != NULL ) {
+        *searched = bg.searched;
+    }
+    if( bg.timeout ) {
+        return -1;
+    }
+
+    /* Every zero-edge is resolved once in a solution */
+    return bg.best*model->fixpoint + zeros*model->bookkeeping;
+}
@@ -0,0 +1,44 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef BITGRAPH_H
+#define BITGRAPH_H
+
+#include "graph.h"
+
+/* Largest graph the bitset solver can handle: one 64 bit word per row */
+#define BITGRAPH_MAX_NODES 64
+
+/* Solve a graph with at most BITGRAPH_MAX_NODES nodes exactly.
+ *
+ * Adjacency is kept as positive/permanent/forbidden bitmasks, and the
+ * search branches on conflict triples depth first, on an explicit stack
+ * of search nodes allocated once per call, without creating any
+ * graphstate_t.
+ *
+ * cliqueid must have room for graph_getNodeCount( graph ) entries, and is
+ * filled with the cluster id of every node. Returns the cost in model, as
+ * the algorithms would report it: the sum of |weight| of all edited pairs
+ * times model->fixpoint, and model->bookkeeping for every zero-edge.
+ * Returns -1, with cliqueid undefined, if the search is still running at
+ * the deadline, as from solve_now. A deadline of 0 is none.
+ *
+ * The number of search nodes expanded is stored in *searched, if not NULL.
+ */
+graph_cost_t bitgraph_solve( const graph_t *graph, const graph_model_t *model, double deadline, graph_index_t *cliqueid, long *searched );
+
+#endif
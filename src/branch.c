@@ -0,0 +1,225 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "debug.h"
+#include "fmem.h"
+#include "graph.h"
+#include "pairsum.h"
+#include "branch.h"
+
+double branch_calc2( graph_cost_t ac, graph_cost_t bc );
+void branch_tablekey( void );
+void branch_tablefree( void *table );
+double branch_maxweight( graph_value_t ab, graph_value_t ac, graph_value_t bc );
+
+const char *branch_names[BRANCH_POLICIES] = {
+    "first",
+    "maxweight",
+    "maxconflict",
+    "branchnum"
+};
+
+int branch_parse( const char *name ) {
+    int i;
+    for( i = 0; i < BRANCH_POLICIES; i++ ) {
+        if( strcmp( branch_names[i], name ) == 0 ) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+double branch_calc2( graph_cost_t ac, graph_cost_t bc ) {
+    double max, min;
+    double z, y, d, a, b;
+    double powzmax, powzmin;
+    a = ac/2.0;
+    b = bc/2.0;
+
+    if( a > b ) {
+        max = a;
+        min = a-b;
+    } else {
+        max = b;
+        min = b-a;
+    }
+
+    z = 2.0;
+
+    do {
+        powzmax = pow( z, max );
+        powzmin = pow( z, min );
+        d = powzmax*max/z - powzmin*min/z;
+        y = powzmax - powzmin - 1;
+        d = y/d;
+        z -= d;
+    } while( d*d > 0.00001 );
+
+    return z;
+}
+
+/* Memoized branching numbers for small vectors, 0.0 if not yet calculated.
+ * The search visits the same few vectors over and over again. Each thread
+ * has its own table, so that instances can be solved in parallel.
+ */
+#define BRANCH_TABLE 256
+typedef double branch_table_t[BRANCH_TABLE][BRANCH_TABLE];
+
+static pthread_once_t branch_tableonce = PTHREAD_ONCE_INIT;
+static pthread_key_t branch_table;
+
+void branch_tablekey( void ) {
+    pthread_key_create( &branch_table, branch_tablefree );
+}
+
+void branch_tablefree( void *table ) {
+    fmem_free( table );
+}
+
+double branch_number2( graph_cost_t ac, graph_cost_t bc ) {
+    branch_table_t *table;
+    double *entry;
+
+    if( ac >= BRANCH_TABLE || bc >= BRANCH_TABLE ) {
+        return branch_calc2( ac, bc );
+    }
+
+    pthread_once( &branch_tableonce, branch_tablekey );
+    table = pthread_getspecific( branch_table );
+    if( table == NULL ) {
+        table = fmem_alloc( sizeof( branch_table_t ) );
+        memset( table, 0, sizeof( branch_table_t ) );
+        pthread_setspecific( branch_table, table );
+    }
+
+    entry = &(*table)[ac][bc];
+    if( *entry == 0.0 ) {
+        *entry = branch_calc2( ac, bc );
+    }
+    return *entry;
+}
+
+double branch_number( const graph_cost_t *vec, int n ) {
+    double lo, hi, x, sum;
+    int i, iter;
+
+    for( i = 0; i < n; i++ ) {
+        if( vec[i] <= 0 ) {
+            return HUGE_VAL; /* A free branch never terminates */
+        }
+    }
+    if( n == 2 ) {
+        return branch_number2( vec[0]*2, vec[1]*2 );
+    }
+
+    /* sum x^-cost is decreasing in x; bisect between 1 and n */
+    lo = 1.0;
+    hi = n;
+    for( iter = 0; iter < 40; iter++ ) {
+        x = ( lo + hi ) / 2.0;
+        sum = 0.0;
+        for( i = 0; i < n; i++ ) {
+            sum += pow( x, -(double)vec[i] );
+        }
+        if( sum > 1.0 ) {
+            lo = x;
+        } else {
+            hi = x;
+        }
+    }
+    return hi;
+}
+
+/* Highest minimum absolute edge weight first */
+double branch_maxweight( graph_value_t ab, graph_value_t ac, graph_value_t bc ) {
+    graph_value_t min;
+
+    ab = ab < 0 ? -ab : ab;
+    ac = ac < 0 ? -ac : ac;
+    bc = bc < 0 ? -bc : bc;
+    min = ab < ac ? ab : ac;
+    min = bc < min ? bc : min;
+    return -(double)min;
+}
+
+int branch_getTriple( int policy, graph_t *graph,
+        pairsum_term_t conflict, pairsum_score_t branchnum,
+        graph_index_t *a, graph_index_t *b, graph_index_t *c ) {
+    pairsum_t *ps;
+    pairsum_score_t score;
+    graph_index_t x, y;
+    graph_cost_t count, maxcount;
+    double best;
+    const graph_index_t *active = graph_getActive( graph );
+    graph_size_t i, j, nodes = graph_getActiveCount( graph );
+
+    /* The best triple of every pair is kept with the conflict counts */
+    score = NULL;
+    if( policy == BRANCH_MAXWEIGHT ) {
+        score = branch_maxweight;
+    } else if( policy == BRANCH_BRANCHNUM ) {
+        score = branchnum;
+    }
+    ps = pairsum_get( graph, conflict, score, PAIRSUM_TRACK | PAIRSUM_SIGN );
+
+    if( policy == BRANCH_FIRST || ps->pairs == 0 ) {
+        return pairsum_getTriple( ps, graph, a, b, c );
+    }
+
+    /* Pairs in the set are those with a nonzero sum, between nodes that are
+     * both part of one
+     */
+    *a = -1;
+    maxcount = 0;
+    best = 0.0;
+    for( i = 0; i < nodes; i++ ) {
+        x = active[i];
+        if( pairsum_getNodePairs( ps, x ) == 0 ) {
+            continue;
+        }
+        for( j = i + 1; j < nodes; j++ ) {
+            y = active[j];
+            count = pairsum_getValue( ps, x, y );
+            if( count == 0 ) {
+                continue;
+            }
+            if( score == NULL ) {
+                if( count > maxcount ) {
+                    maxcount = count;
+                    *a = x < y ? x : y;
+                    *b = x < y ? y : x;
+                }
+            } else if( *a < 0 || pairsum_getBest( ps, x, y ) < best ) {
+                best = pairsum_getBest( ps, x, y );
+                *a = x < y ? x : y;
+                *b = x < y ? y : x;
+                *c = pairsum_getBestThird( ps, x, y );
+            }
+        }
+    }
+
+    if( score == NULL ) {
+        /* First third node for the pair */
+        *c = pairsum_getThird( ps, graph, *a, *b );
+    }
+    ASSERT( *c >= 0 ); /* A nonzero sum has a nonzero term */
+    return 1;
+}
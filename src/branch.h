@@ -0,0 +1,55 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef BRANCH_H
+#define BRANCH_H
+
+#include "graph.h"
+#include "pairsum.h"
+
+/* Policies for selecting the conflict triple to branch on */
+#define BRANCH_FIRST        0   /* First triple in node order */
+#define BRANCH_MAXWEIGHT    1   /* Highest minimum absolute edge weight */
+#define BRANCH_MAXCONFLICT  2   /* Pair involved in the most conflicts */
+#define BRANCH_BRANCHNUM    3   /* Least branching number */
+#define BRANCH_POLICIES     4
+
+extern const char *branch_names[BRANCH_POLICIES];
+
+/* Returns the policy with the given name, or -1 */
+int branch_parse( const char *name );
+
+/* Branching number of a vector of n costs; the root of sum x^-cost = 1 */
+double branch_number( const graph_cost_t *vec, int n );
+
+/* Branching number of the vector (ac/2,bc/2), in the half units of the
+ * (2,1) cost model, both positive. Memoized for small costs.
+ */
+double branch_number2( graph_cost_t ac, graph_cost_t bc );
+
+/* Select a conflict triple, where (a,b) is the pair and c the third node.
+ * The conflict term is tracked with pairsum, and branchnum scores a triple
+ * by the branching number of the algorithm for BRANCH_BRANCHNUM. The
+ * best triple of every pair is kept up to date with the conflict counts,
+ * so only the pairs are visited. The pair is returned lower node first.
+ * Returns 0 if there is no conflict triple.
+ */
+int branch_getTriple( int policy, graph_t *graph,
+        pairsum_term_t conflict, pairsum_score_t branchnum,
+        graph_index_t *a, graph_index_t *b, graph_index_t *c );
+
+#endif
@@ -0,0 +1,233 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <glob.h>
+#include "graph.h"
+#include "debug.h"
+#include "fmem.h"
+#include "datasource.h"
+#include "datasource_batch.h"
+#include "graphfile.h"
+#include "visual.h"
+
+void *datasource_batch_create( char *args );
+void datasource_batch_free( void *storage );
+graph_t *datasource_batch_get( void *storage );
+void datasource_batch_show( void *storage, graph_t *graph, graph_index_t *cliqueid );
+
+const datasource_t datasource_batch = {
+    datasource_batch_create,
+    datasource_batch_free,
+    datasource_batch_get,
+    datasource_batch_show
+};
+
+/* Names of the instances handed out and not yet shown, in order */
+typedef struct datasource_batch_name_t {
+    char *name;
+    struct datasource_batch_name_t *next;
+} datasource_batch_name_t;
+
+typedef struct datasource_batch_storage_t {
+    char **files;           /* Files of a directory or pattern, or NULL */
+    long count, next;
+
+    char *source;           /* Name of the stream, if no files */
+    graphfile_stream_t *stream;
+    long instances;
+
+    datasource_batch_name_t *first, *last;
+} datasource_batch_storage_t;
+
+char *datasource_batch_strdup( const char *str, const char *suffix );
+int datasource_batch_compare( const void *a, const void *b );
+void datasource_batch_list( datasource_batch_storage_t *s, const char *dir );
+void datasource_batch_glob( datasource_batch_storage_t *s, const char *pattern );
+void datasource_batch_push( datasource_batch_storage_t *s, char *name );
+
+
+/* Copy of str followed by suffix */
+char *datasource_batch_strdup( const char *str, const char *suffix ) {
+    char *copy = fmem_alloc( strlen( str ) + strlen( suffix ) + 1 );
+    strcpy( copy, str );
+    strcat( copy, suffix );
+    return copy;
+}
+
+int datasource_batch_compare( const void *a, const void *b ) {
+    return strcmp( *(char * const *)a, *(char * const *)b );
+}
+
+/* The regular files of dir, except hidden ones, by name */
+void datasource_batch_list( datasource_batch_storage_t *s, const char *dir ) {
+    DIR *d;
+    struct dirent *ent;
+    struct stat st;
+    char **files, *path;
+    long size = 0;
+
+    d = opendir( dir );
+    if( d == NULL ) {
+        return;
+    }
+    while( ( ent = readdir( d ) ) != NULL ) {
+        if( ent->d_name[0] == '.' ) {
+            continue;
+        }
+        path = fmem_alloc( strlen( dir ) + strlen( ent->d_name ) + 2 );
+        sprintf( path, "%s/%s", dir, ent->d_name );
+        if( stat( path, &st ) != 0 || !S_ISREG( st.st_mode ) ) {
+            fmem_free( path );
+            continue;
+        }
+        if( s->count == size ) {
+            size = size ? size * 2 : 64;
+            files = fmem_alloc_arr( sizeof( char * ), size );
+            if( s->count > 0 ) {
+                memcpy( files, s->files, sizeof( char * ) * s->count );
+            }
+            fmem_free( s->files );
+            s->files = files;
+        }
+        s->files[s->count++] = path;
+    }
+    closedir( d );
+
+    if( s->count > 0 ) {
+        qsort( s->files, s->count, sizeof( char * ), datasource_batch_compare );
+    }
+}
+
+/* The paths matching pattern, sorted by glob */
+void datasource_batch_glob( datasource_batch_storage_t *s, const char *pattern ) {
+    glob_t g;
+    size_t i;
+
+    if( glob( pattern, 0, NULL, &g ) != 0 ) {
+        return;
+    }
+    s->files = fmem_alloc_arr( sizeof( char * ), g.gl_pathc + 1 );
+    for( i = 0; i < g.gl_pathc; i++ ) {
+        s->files[s->count++] = datasource_batch_strdup( g.gl_pathv[i], "" );
+    }
+    globfree( &g );
+}
+
+void *datasource_batch_create( char *args ) {
+    datasource_batch_storage_t *s = fmem_alloc( sizeof( datasource_batch_storage_t ) );
+    struct stat st;
+
+    s->files = NULL;
+    s->count = 0;
+    s->next = 0;
+    s->source = args;
+    s->stream = NULL;
+    s->instances = 0;
+    s->first = NULL;
+    s->last = NULL;
+
+    if( strcmp( args, "-" ) != 0 && stat( args, &st ) == 0 && S_ISDIR( st.st_mode ) ) {
+        datasource_batch_list( s, args );
+    } else if( strpbrk( args, "*?[" ) != NULL ) {
+        datasource_batch_glob( s, args );
+    } else {
+        s->stream = graphfile_openstream( args );
+        if( s->stream == NULL ) {
+            fprintf( stderr, "Can't read %s\n", args );
+        }
+    }
+    return (void*)s;
+}
+
+void datasource_batch_free( void *storage ) {
+    datasource_batch_storage_t *s = (datasource_batch_storage_t *)storage;
+    datasource_batch_name_t *cur;
+    long i;
+
+    for( i = 0; i < s->count; i++ ) {
+        fmem_free( s->files[i] );
+    }
+    fmem_free( s->files );
+    if( s->stream != NULL ) {
+        graphfile_closestream( s->stream );
+    }
+    while( ( cur = s->first ) != NULL ) {
+        s->first = cur->next;
+        fmem_free( cur->name );
+        fmem_free( cur );
+    }
+    fmem_free( storage );
+}
+
+void datasource_batch_push( datasource_batch_storage_t *s, char *name ) {
+    datasource_batch_name_t *cur = fmem_alloc( sizeof( datasource_batch_name_t ) );
+    cur->name = name;
+    cur->next = NULL;
+    if( s->last != NULL ) {
+        s->last->next = cur;
+    } else {
+        s->first = cur;
+    }
+    s->last = cur;
+}
+
+graph_t *datasource_batch_get( void *storage ) {
+    datasource_batch_storage_t *s = (datasource_batch_storage_t *)storage;
+    graph_t *graph = NULL;
+    char suffix[32];
+
+    if( s->stream != NULL ) {
+        graph = graphfile_readstream( s->stream );
+        if( graph != NULL ) {
+            sprintf( suffix, ":%ld", ++s->instances );
+            datasource_batch_push( s, datasource_batch_strdup( s->source, suffix ) );
+        }
+        return graph;
+    }
+
+    while( graph == NULL && s->next < s->count ) {
+        graph = graphfile_readfile( s->files[s->next] );
+        if( graph == NULL ) {
+            fprintf( stderr, "Can't read %s\n", s->files[s->next] );
+        } else {
+            datasource_batch_push( s, datasource_batch_strdup( s->files[s->next], "" ) );
+        }
+        s->next++;
+    }
+    return graph;
+}
+
+void datasource_batch_show( void *storage, graph_t *graph, graph_index_t *cliqueid ) {
+    datasource_batch_storage_t *s = (datasource_batch_storage_t *)storage;
+    datasource_batch_name_t *cur = s->first;
+
+    ASSERT( cur != NULL );
+    s->first = cur->next;
+    if( s->first == NULL ) {
+        s->last = NULL;
+    }
+
+    visual_showInstance( graph, cliqueid, cur->name );
+    fmem_free( cur->name );
+    fmem_free( cur );
+}
@@ -0,0 +1,30 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef DATASOURCE_BATCH_H
+#define DATASOURCE_BATCH_H
+
+#include "datasource.h"
+
+/* Many instances, from the files of a directory, the files matching a
+ * glob pattern, or a file of concatenated graphs ("-" for standard input,
+ * see graphfile_openstream). Each result is shown with the name of its
+ * instance. Meant to be solved by batch_run.
+ */
+extern const datasource_t datasource_batch;
+
+#endif
@@ -17,48 +17,632 @@
  */
 #include <stdlib.h>
 
+#include <limits.h>
+#include <string.h>
+#include <stdint.h>
+
 #include "debug.h"
 #include "graph.h"
+#include "graphsparse.h"
 #include "fmem.h"
 
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__LP64__)
+#define GRAPH_AVX2
+#include <immintrin.h>
+#endif
+
 /* TODO: Indexing node vector shares code with set all costs */
     
+/* Rows of square graphs are aligned to this number of values */
+#define GRAPH_SQUARE_ALIGN 4
+
+/* Alignment of the stored values, in bytes */
+#define GRAPH_EDGES_ALIGN 32
+
+/* If enough nodes are active for the row kernels, which go over all
+ * columns, to be faster than walking the list of active nodes
+ */
+#define GRAPH_ROWS_DENSE( _G ) ( (_G)->count >= (_G)->nodes / 8 )
+
+/* Binary files. Sections are page aligned, so that a mapped file can be
+ * used in place. Values are in native byte order and checked on load.
+ */
+#define GRAPH_BINARY_MAGIC     "CEGRAPH"
+#define GRAPH_BINARY_VERSION   1
+#define GRAPH_BINARY_BYTEORDER 0x01020304UL
+#define GRAPH_BINARY_ALIGN     4096
+
+typedef struct graph_binary_t {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    byteorder;
+    uint32_t    valuesize;  /* sizeof( graph_value_t ) */
+    uint32_t    width;
+    uint32_t    layout;
+    uint32_t    reserved;
+    uint64_t    nodes;
+    uint64_t    size;
+    uint64_t    stride;
+    uint64_t    forbidden;  /* File offsets of the sections */
+    uint64_t    persistant;
+    uint64_t    edges;
+    uint64_t    end;
+} graph_binary_t;
+
+#define GRAPH_FLAG_BITS ( 8*sizeof(unsigned long) )
+#define GRAPH_FLAG_WORDS( _N ) ( ( (_N) + GRAPH_FLAG_BITS - 1 ) / GRAPH_FLAG_BITS )
+#define GRAPH_FLAG_MASK( _P ) ( 1UL << ( (_P) % GRAPH_FLAG_BITS ) )
+#define GRAPH_FLAG_TEST( _F, _P ) ( ( (_F)[ (_P) / GRAPH_FLAG_BITS ] & GRAPH_FLAG_MASK( _P ) ) != 0 )
+
+/* Row _N of the sign plane for sign _S, in -1..1 */
+#define GRAPH_SIGNROW( _G, _S, _N ) ( (_G)->signs + ( ((_S)+1)*(_G)->nodes + (_N) ) * (_G)->words )
+#define GRAPH_SIGNOF( _V ) ( (_V) > 0 ? 1 : ( (_V) < 0 ? -1 : 0 ) )
+
+#if defined(__GNUC__)
+#define GRAPH_POPCOUNT( _X ) __builtin_popcountl( _X )
+#define GRAPH_CTZ( _X )      __builtin_ctzl( _X )
+#else
+#define GRAPH_POPCOUNT( _X ) graph_popcount( _X )
+#define GRAPH_CTZ( _X )      graph_ctz( _X )
+#endif
+
+/* Position of the edge (n1,n2) in edges; square graphs has a second copy */
+#define GRAPH_POS_TRIANGULAR( _G, _N1, _N2 ) GRAPH_EDGE_IDX( _N1, _N2 )
+#define GRAPH_POS_SQUARE( _G, _N1, _N2 ) ( (_N1)*(_G)->stride + (_N2) )
+#define GRAPH_POS( _G, _N1, _N2 ) ( (_G)->layout == GRAPH_LAYOUT_SQUARE ? \
+        GRAPH_POS_SQUARE( _G, _N1, _N2 ) : GRAPH_POS_TRIANGULAR( _G, _N1, _N2 ) )
+
+/* Index of a width in the tables of changeset handlers */
+#define GRAPH_WIDTH_INDEX( _W ) ( (_W) == 1 ? 0 : ( (_W) == 2 ? 1 : ( (_W) == 4 ? 2 : 3 ) ) )
+
+#define GRAPH_ISACTIVE( _G, _N ) ( (_G)->position[_N] < (_G)->count )
+
+/* Value of edges not stored in a sparse graph */
+#define GRAPH_IMPLICIT( _G, _N1, _N2 ) ( (_G)->fill * (_G)->members[_N1] * (_G)->members[_N2] )
+
+static graph_value_t graph_offset( graph_value_t val, int *flag );
+static int graph_widthOf( graph_value_t val );
+static void graph_allocEdges( graph_t *graph, int width );
+static void graph_widen( graph_t *graph, int width );
+static graph_value_t graph_flagged( const graph_t *graph, graph_size_t pos, graph_value_t ofs );
+static graph_value_t graph_load1( const graph_t *graph, graph_size_t pos );
+static graph_value_t graph_load2( const graph_t *graph, graph_size_t pos );
+static graph_value_t graph_load4( const graph_t *graph, graph_size_t pos );
+static graph_value_t graph_loadMax( const graph_t *graph, graph_size_t pos );
+static int graph_putNarrow( graph_t *graph, graph_size_t pos, graph_value_t val, int width );
+static int graph_put1( graph_t *graph, graph_size_t pos, graph_value_t val );
+static int graph_put2( graph_t *graph, graph_size_t pos, graph_value_t val );
+static int graph_put4( graph_t *graph, graph_size_t pos, graph_value_t val );
+static int graph_putMax( graph_t *graph, graph_size_t pos, graph_value_t val );
+static graph_value_t graph_load( const graph_t *graph, graph_size_t pos );
+static void graph_store( graph_t *graph, graph_size_t pos, graph_value_t val );
+static void graph_storeEdge( graph_t *graph, graph_index_t n1, graph_index_t n2, graph_value_t val );
+static graph_cost_t graph_mergeCost( graph_value_t ev1, graph_value_t ev2, graph_cost_t fixpoint, graph_cost_t bookkeepingValue );
+static graph_cost_t graph_mergeRest( graph_t *graph, graph_chSet_t *chs, graph_size_t k, graph_cost_t fixpoint, graph_cost_t bookkeepingValue );
+static void graph_splitRest( graph_t *graph, graph_chSet_t *chs, graph_size_t k );
+static graph_size_t graph_mergeMasked( int *row1, const int *row2, const int *mask, graph_size_t n, graph_cost_t fixpoint, graph_cost_t bookkeepingValue, graph_cost_t *cost );
+static graph_size_t graph_splitMasked( int *row1, const int *row2, const int *mask, graph_size_t n );
+#ifdef GRAPH_AVX2
+static graph_size_t graph_mergeMaskedAvx2( int *row1, const int *row2, const int *mask, graph_size_t n, graph_cost_t fixpoint, graph_cost_t bookkeepingValue, graph_cost_t *cost );
+static graph_size_t graph_splitMaskedAvx2( int *row1, const int *row2, const int *mask, graph_size_t n );
+#endif
+static graph_size_t graph_copyIntColumn( graph_t *graph, graph_index_t n1, graph_index_t n2, graph_index_t end );
+static graph_size_t graph_mergeRows( graph_t *graph, graph_index_t n1, graph_index_t n2, graph_cost_t fixpoint, graph_cost_t bookkeepingValue, graph_cost_t *cost );
+static graph_size_t graph_splitRows( graph_t *graph, graph_index_t n1, graph_index_t n2 );
+static graph_value_t graph_sparseGet( const graph_t *graph, graph_index_t n1, graph_index_t n2 );
+static void graph_sparseSet( graph_t *graph, graph_index_t n1, graph_index_t n2, graph_value_t val );
+static graph_size_t graph_sparseGather( graph_t *graph, graph_index_t n1, graph_index_t n2 );
+static graph_cost_t graph_sparseMerge( graph_t *graph, graph_size_t n, graph_cost_t fixpoint, graph_cost_t bookkeepingValue );
+#if !defined(__GNUC__)
+static int graph_popcount( unsigned long x );
+static int graph_ctz( unsigned long x );
+#endif
+static void graph_signSet( graph_t *graph, graph_index_t n1, graph_index_t n2, graph_value_t val );
+static void graph_signRow( graph_t *graph, graph_index_t n );
+static void graph_signFill( graph_t *graph );
+static graph_index_t graph_removeNode( graph_t *graph, graph_index_t n );
+static void graph_restoreNode( graph_t *graph, graph_index_t n, graph_index_t pos );
+static void graph_initLayout( graph_t *graph, int layout );
+static void graph_initNodes( graph_t *graph );
+static void graph_release( graph_t *graph, void *ptr );
+static uint64_t graph_binaryAlign( uint64_t ofs );
+static int graph_binarySection( FILE *fp, uint64_t *cur, uint64_t ofs, const void *data, uint64_t len );
+
+static int graph_defaultLayout = GRAPH_LAYOUT_DEFAULT;
+static int graph_defaultWidth = GRAPH_WIDTH_DEFAULT;
+
+void graph_setDefaultLayout( int layout ) {
+    ASSERT( layout >= 0 && layout < GRAPH_LAYOUTS );
+    graph_defaultLayout = layout;
+}
+
+void graph_setDefaultWidth( int width ) {
+    ASSERT( width == 1 || width == 2 || width == 4 || width == GRAPH_WIDTH_MAX );
+    graph_defaultWidth = width;
+}
+
+/* Split val into the sentinel it is decided by, as flag -1, 0 or 1, and
+ * the offset from it
+ */
+static graph_value_t graph_offset( graph_value_t val, int *flag ) {
+    if( GRAPH_ISFORBIDDEN( val ) ) {
+        *flag = -1;
+        return val - GRAPH_VALUE_FORBIDDEN;
+    }
+    if( GRAPH_ISPERSISTANT( val ) ) {
+        *flag = 1;
+        return val - GRAPH_VALUE_PERSISTANT;
+    }
+    *flag = 0;
+    return val;
+}
+
+/* Narrowest width able to store val */
+static int graph_widthOf( graph_value_t val ) {
+    graph_value_t   ofs;
+    int             flag;
+
+    ofs = graph_offset( val, &flag );
+    if( ofs >= SCHAR_MIN && ofs <= SCHAR_MAX ) {
+        return 1;
+    }
+    if( ofs >= SHRT_MIN && ofs <= SHRT_MAX ) {
+        return 2;
+    }
+    if( val >= INT_MIN && val <= INT_MAX ) {
+        return 4;
+    }
+    return GRAPH_WIDTH_MAX;
+}
+
+/* Allocate storage for graph->size values of width, and the flag bitmaps
+ * if needed. The values are left uninitialized.
+ */
+static void graph_allocEdges( graph_t *graph, int width ) {
+    size_t  misalign;
+
+    graph->width = width;
+
+    /* Over allocate to align the rows */
+    graph->edges_mem = fmem_alloc( graph->size*width + GRAPH_EDGES_ALIGN );
+    misalign = ( (size_t)graph->edges_mem ) % GRAPH_EDGES_ALIGN;
+    graph->edges = (char *)graph->edges_mem + ( misalign ? GRAPH_EDGES_ALIGN - misalign : 0 );
+
+    if( width < 4 ) {
+        graph->forbidden = fmem_alloc_arr( sizeof(unsigned long), GRAPH_FLAG_WORDS( graph->size ) );
+        graph->persistant = fmem_alloc_arr( sizeof(unsigned long), GRAPH_FLAG_WORDS( graph->size ) );
+        memset( graph->forbidden, 0, sizeof(unsigned long)*GRAPH_FLAG_WORDS( graph->size ) );
+        memset( graph->persistant, 0, sizeof(unsigned long)*GRAPH_FLAG_WORDS( graph->size ) );
+    } else {
+        graph->forbidden = NULL;
+        graph->persistant = NULL;
+    }
+}
+
+/* Convert all stored values to a larger width. Only done when a value
+ * doesn't fit, so at most three times per graph.
+ */
+static void graph_widen( graph_t *graph, int width ) {
+    graph_t         old;
+    graph_size_t    pos;
+
+    ASSERT( width > graph->width );
+    DBGINT( 5, width );
+
+    old = *graph;
+    graph_allocEdges( graph, width );
+    for( pos=0; pos<graph->size; pos++ ) {
+        graph_store( graph, pos, graph_load( &old, pos ) );
+    }
+
+    graph_release( graph, old.edges_mem );
+    graph_release( graph, old.forbidden );
+    graph_release( graph, old.persistant );
+}
+
+/* Add the sentinel flagged for pos to the offset stored in a narrow width */
+static graph_value_t graph_flagged( const graph_t *graph, graph_size_t pos, graph_value_t ofs ) {
+    if( GRAPH_FLAG_TEST( graph->forbidden, pos ) ) {
+        return ofs + GRAPH_VALUE_FORBIDDEN;
+    }
+    if( GRAPH_FLAG_TEST( graph->persistant, pos ) ) {
+        return ofs + GRAPH_VALUE_PERSISTANT;
+    }
+    return ofs;
+}
+
+/* Load and store for a known width. The changeset handlers are instantiated
+ * per width with these, graph_load and graph_store pick one by the width of
+ * the graph. The put functions return 0, storing nothing, if val doesn't
+ * fit the width.
+ */
+static graph_value_t graph_load1( const graph_t *graph, graph_size_t pos ) {
+    return graph_flagged( graph, pos, ( (const signed char *)graph->edges )[pos] );
+}
+
+static graph_value_t graph_load2( const graph_t *graph, graph_size_t pos ) {
+    return graph_flagged( graph, pos, ( (const short *)graph->edges )[pos] );
+}
+
+static graph_value_t graph_load4( const graph_t *graph, graph_size_t pos ) {
+    return ( (const int *)graph->edges )[pos];
+}
+
+static graph_value_t graph_loadMax( const graph_t *graph, graph_size_t pos ) {
+    return ( (const graph_value_t *)graph->edges )[pos];
+}
+
+static int graph_putNarrow( graph_t *graph, graph_size_t pos, graph_value_t val, int width ) {
+    graph_value_t   ofs;
+    int             flag;
+    graph_size_t    word;
+    unsigned long   mask;
+
+    ofs = graph_offset( val, &flag );
+    if( width == 1 ) {
+        if( ofs < SCHAR_MIN || ofs > SCHAR_MAX ) {
+            return 0;
+        }
+        ( (signed char *)graph->edges )[pos] = (signed char)ofs;
+    } else {
+        if( ofs < SHRT_MIN || ofs > SHRT_MAX ) {
+            return 0;
+        }
+        ( (short *)graph->edges )[pos] = (short)ofs;
+    }
+
+    word = pos / GRAPH_FLAG_BITS;
+    mask = GRAPH_FLAG_MASK( pos );
+    if( flag < 0 ) {
+        graph->forbidden[word] |= mask;
+    } else {
+        graph->forbidden[word] &= ~mask;
+    }
+    if( flag > 0 ) {
+        graph->persistant[word] |= mask;
+    } else {
+        graph->persistant[word] &= ~mask;
+    }
+    return 1;
+}
+
+static int graph_put1( graph_t *graph, graph_size_t pos, graph_value_t val ) {
+    return graph_putNarrow( graph, pos, val, 1 );
+}
+
+static int graph_put2( graph_t *graph, graph_size_t pos, graph_value_t val ) {
+    return graph_putNarrow( graph, pos, val, 2 );
+}
+
+static int graph_put4( graph_t *graph, graph_size_t pos, graph_value_t val ) {
+    if( val < INT_MIN || val > INT_MAX ) {
+        return 0;
+    }
+    ( (int *)graph->edges )[pos] = (int)val;
+    return 1;
+}
+
+static int graph_putMax( graph_t *graph, graph_size_t pos, graph_value_t val ) {
+    ( (graph_value_t *)graph->edges )[pos] = val;
+    return 1;
+}
+
+static graph_value_t graph_load( const graph_t *graph, graph_size_t pos ) {
+    switch( graph->width ) {
+        case 1:
+            return graph_load1( graph, pos );
+        case 2:
+            return graph_load2( graph, pos );
+        case 4:
+            return graph_load4( graph, pos );
+        default:
+            return graph_loadMax( graph, pos );
+    }
+}
+
+static void graph_store( graph_t *graph, graph_size_t pos, graph_value_t val ) {
+    int stored;
+
+    switch( graph->width ) {
+        case 1:
+            stored = graph_put1( graph, pos, val );
+            break;
+        case 2:
+            stored = graph_put2( graph, pos, val );
+            break;
+        case 4:
+            stored = graph_put4( graph, pos, val );
+            break;
+        default:
+            stored = graph_putMax( graph, pos, val );
+            break;
+    }
+
+    /* Overflow, as from the sums when merging */
+    if( !stored ) {
+        graph_widen( graph, graph_widthOf( val ) );
+        graph_store( graph, pos, val );
+    }
+}
+
+/* Store the edge (n1,n2) of a triangular or square graph, in all copies */
+static void graph_storeEdge( graph_t *graph, graph_index_t n1, graph_index_t n2, graph_value_t val ) {
+    graph_store( graph, GRAPH_POS( graph, n1, n2 ), val );
+    if( graph->layout == GRAPH_LAYOUT_SQUARE ) {
+        graph_store( graph, GRAPH_POS( graph, n2, n1 ), val );
+    }
+}
+
+/* Layout fields and the size of the edge storage, for graph->nodes */
+static void graph_initLayout( graph_t *graph, int layout ) {
+    graph->layout = layout;
+
+    graph->rows = NULL;
+    graph->members = NULL;
+    graph->fill = -1;
+
+    graph->signs = NULL;
+    graph->activebits = NULL;
+    graph->words = GRAPH_FLAG_WORDS( graph->nodes );
+
+    graph->map = NULL;
+    graph->mapsize = 0;
+    graph->unmap = NULL;
+
+    if( graph->layout == GRAPH_LAYOUT_SQUARE ) {
+        graph->stride = ( graph->nodes + GRAPH_SQUARE_ALIGN - 1 ) / GRAPH_SQUARE_ALIGN * GRAPH_SQUARE_ALIGN;
+        graph->size = graph->nodes * graph->stride;
+    } else if( graph->layout == GRAPH_LAYOUT_SPARSE ) {
+        graph->stride = 0;
+        graph->size = 0;
+    } else {
+        graph->stride = 0;
+        graph->size = GRAPH_EDGE_IDX( graph->nodes, 0 ); /* (nodes * (nodes - 1) >> 1); */
+    }
+}
+
+/* Active list, with all nodes active, the scratch rows of the sparse
+ * layout and the mask of active columns of the square layout
+ */
+static void graph_initNodes( graph_t *graph ) {
+    graph_index_t   i;
+
+    /*
+     * Node 0 is never removed, as merges keep the lower node, so
+     * iteration can always start at it
+     */
+    graph->active = fmem_alloc_arr(sizeof(graph_index_t), graph->nodes);
+    graph->position = fmem_alloc_arr(sizeof(graph_index_t), graph->nodes);
+    for( i=0; i<graph->nodes; i++ ) {
+        graph->active[i] = i;
+        graph->position[i] = i;
+    }
+    graph->count = graph->nodes;
+
+    if( graph->layout == GRAPH_LAYOUT_SPARSE ) {
+        graph->row1 = fmem_alloc_arr(sizeof(graph_value_t), graph->nodes);
+        graph->row2 = fmem_alloc_arr(sizeof(graph_value_t), graph->nodes);
+        graph->rowidx = fmem_alloc_arr(sizeof(graph_index_t), graph->nodes);
+    } else {
+        graph->row1 = NULL;
+        graph->row2 = NULL;
+        graph->rowidx = NULL;
+    }
+
+    if( graph->layout == GRAPH_LAYOUT_SQUARE ) {
+        graph->activemask = fmem_alloc_arr(sizeof(int), graph->nodes);
+        for( i=0; i<graph->nodes; i++ ) {
+            graph->activemask[i] = -1;
+        }
+    } else {
+        graph->activemask = NULL;
+    }
+}
+
+/* Free ptr, unless it points into the mapped file */
+static void graph_release( graph_t *graph, void *ptr ) {
+    if( graph->map != NULL && (char *)ptr >= (char *)graph->map &&
+            (char *)ptr < (char *)graph->map + graph->mapsize ) {
+        return;
+    }
+    fmem_free( ptr );
+}
+
 graph_t *graph_create( graph_size_t nodes ) {
-    graph_size_t    edges;
     graph_index_t   i;
     graph_t         *graph;
 
     graph = fmem_alloc(sizeof(graph_t));
     graph->nodes = nodes;
-
-    edges = GRAPH_EDGE_IDX( nodes, 0 ); /* (nodes * (nodes - 1) >> 1); */
+    graph->listeners = NULL;
+    graph_initLayout( graph, graph_defaultLayout );
 
     if( graph->nodes == 0 ) {
+        graph->width = graph_defaultWidth;
+        graph->edges_mem = NULL;
+        graph->edges = NULL;
+        graph->forbidden = NULL;
+        graph->persistant = NULL;
+        graph->active = NULL;
+        graph->position = NULL;
+        graph->count = 0;
+        graph->row1 = NULL;
+        graph->row2 = NULL;
+        graph->rowidx = NULL;
+        graph->activemask = NULL;
+    } else if( graph->layout == GRAPH_LAYOUT_SPARSE ) {
+        /* All edges are implicitly -1 */
+        graph->width = GRAPH_WIDTH_MAX;
+        graph->edges_mem = NULL;
         graph->edges = NULL;
-        graph->node = NULL;
+        graph->forbidden = NULL;
+        graph->persistant = NULL;
+        graph->rows = fmem_alloc_arr( sizeof( graphsparse_row_t ), nodes );
+        graph->members = fmem_alloc_arr( sizeof( graph_size_t ), nodes );
+        for( i=0; i<nodes; i++ ) {
+            graphsparse_init( &graph->rows[i] );
+            graph->members[i] = 1;
+        }
     } else {
-        graph->edges = fmem_alloc_arr(sizeof(graph_value_t), edges);
-        for (i = 0; i < edges; i++) {
-            graph->edges[i] = -1;
+        graph_allocEdges( graph, graph_defaultWidth );
+        for (i = 0; i < graph->size; i++) {
+            graph_store( graph, i, -1 );
         }
+    }
 
-        /*
-         * A dummy node is inserted in the nodes array
-         * to ensure that we always can find the first existing node
-         */
-        graph->node = fmem_alloc_arr(sizeof(graph_index_t), nodes);
+    if( graph->nodes > 0 ) {
+        graph_initNodes( graph );
+    }
+    return graph;
+}
 
-        for(i=0; i<nodes-1; i++) 
-            graph->node[i] = i+1;
-        
-        graph->node[nodes-1] = -1;
+/* Round up to the alignment of the sections of a binary file */
+static uint64_t graph_binaryAlign( uint64_t ofs ) {
+    return ( ofs + GRAPH_BINARY_ALIGN - 1 ) / GRAPH_BINARY_ALIGN * GRAPH_BINARY_ALIGN;
+}
+
+/* Write section of len bytes at ofs, padding from the current offset */
+static int graph_binarySection( FILE *fp, uint64_t *cur, uint64_t ofs, const void *data, uint64_t len ) {
+    static const char zeros[64] = { 0 };
+    uint64_t pad;
+
+    for( ; *cur < ofs; *cur += pad ) {
+        pad = ofs - *cur < sizeof( zeros ) ? ofs - *cur : sizeof( zeros );
+        if( fwrite( zeros, 1, pad, fp ) != pad ) {
+            return 0;
+        }
+    }
+    if( len > 0 && fwrite( data, 1, len, fp ) != len ) {
+        return 0;
+    }
+    *cur += len;
+    return 1;
+}
+
+int graph_writeBinary( const graph_t *graph, FILE *fp ) {
+    graph_binary_t  hdr;
+    uint64_t        cur, flagbytes;
+
+    if( ( graph->layout != GRAPH_LAYOUT_TRIANGULAR && graph->layout != GRAPH_LAYOUT_SQUARE ) ||
+            graph->nodes == 0 || graph->count != graph->nodes ) {
+        return 0;
+    }
+
+    memset( &hdr, 0, sizeof( hdr ) );
+    memcpy( hdr.magic, GRAPH_BINARY_MAGIC, sizeof( hdr.magic ) );
+    hdr.version = GRAPH_BINARY_VERSION;
+    hdr.byteorder = GRAPH_BINARY_BYTEORDER;
+    hdr.valuesize = sizeof( graph_value_t );
+    hdr.width = graph->width;
+    hdr.layout = graph->layout;
+    hdr.nodes = graph->nodes;
+    hdr.size = graph->size;
+    hdr.stride = graph->stride;
+
+    flagbytes = graph->width < 4 ? sizeof(unsigned long)*GRAPH_FLAG_WORDS( graph->size ) : 0;
+    hdr.forbidden = graph_binaryAlign( sizeof( hdr ) );
+    hdr.persistant = hdr.forbidden + flagbytes;
+    hdr.edges = graph_binaryAlign( hdr.persistant + flagbytes );
+    hdr.end = hdr.edges + (uint64_t)graph->size*graph->width;
+
+    cur = 0;
+    return graph_binarySection( fp, &cur, 0, &hdr, sizeof( hdr ) ) &&
+        graph_binarySection( fp, &cur, hdr.forbidden, graph->forbidden, flagbytes ) &&
+        graph_binarySection( fp, &cur, hdr.persistant, graph->persistant, flagbytes ) &&
+        graph_binarySection( fp, &cur, hdr.edges, graph->edges, hdr.end - hdr.edges );
+}
+
+int graph_isBinary( const void *data, size_t size ) {
+    return size >= sizeof( graph_binary_t ) &&
+        memcmp( data, GRAPH_BINARY_MAGIC, sizeof( ((graph_binary_t *)0)->magic ) ) == 0;
+}
+
+graph_t *graph_createMapped( void *data, size_t size, void (*unmap)( void *, size_t ) ) {
+    graph_binary_t  hdr;
+    graph_t         layout, *graph;
+    uint64_t        flagbytes;
+
+    if( !graph_isBinary( data, size ) ) {
+        return NULL;
+    }
+    memcpy( &hdr, data, sizeof( hdr ) );
+    if( hdr.version != GRAPH_BINARY_VERSION || hdr.byteorder != GRAPH_BINARY_BYTEORDER ||
+            hdr.valuesize != sizeof( graph_value_t ) ||
+            ( hdr.layout != GRAPH_LAYOUT_TRIANGULAR && hdr.layout != GRAPH_LAYOUT_SQUARE ) ||
+            ( hdr.width != 1 && hdr.width != 2 && hdr.width != 4 && hdr.width != GRAPH_WIDTH_MAX ) ||
+            hdr.nodes == 0 || hdr.nodes > GRAPH_NODES_MAX ||
+            hdr.forbidden > hdr.edges || hdr.edges > hdr.end || hdr.end > size ) {
+        return NULL;
     }
+
+    /* The sections must be where this build would put them. The node
+     * count is bounded, so the sizes can't overflow, and the edges must fit
+     * in the file, so nothing is allocated for nodes that aren't there.
+     */
+    layout.nodes = hdr.nodes;
+    graph_initLayout( &layout, hdr.layout );
+    flagbytes = hdr.width < 4 ? sizeof(unsigned long)*GRAPH_FLAG_WORDS( layout.size ) : 0;
+    if( hdr.size != (uint64_t)layout.size || hdr.stride != (uint64_t)layout.stride ||
+            hdr.forbidden < sizeof( hdr ) || hdr.forbidden % sizeof(unsigned long) != 0 || hdr.persistant != hdr.forbidden + flagbytes ||
+            hdr.edges % GRAPH_EDGES_ALIGN != 0 || hdr.persistant + flagbytes > hdr.edges ||
+            hdr.end != hdr.edges + (uint64_t)layout.size*hdr.width ) {
+        return NULL;
+    }
+
+    graph = fmem_alloc(sizeof(graph_t));
+    graph->nodes = hdr.nodes;
+    graph->listeners = NULL;
+    graph_initLayout( graph, hdr.layout );
+
+    graph->map = data;
+    graph->mapsize = size;
+    graph->unmap = unmap;
+
+    graph->width = hdr.width;
+    graph->edges_mem = NULL;
+    graph->edges = (char *)data + hdr.edges;
+    if( flagbytes > 0 ) {
+        graph->forbidden = (unsigned long *)( (char *)data + hdr.forbidden );
+        graph->persistant = (unsigned long *)( (char *)data + hdr.persistant );
+    } else {
+        graph->forbidden = NULL;
+        graph->persistant = NULL;
+    }
+
+    graph_initNodes( graph );
     return graph;
 }
 
 void graph_free( graph_t *graph ) {
-    fmem_free(graph->edges);
-    fmem_free(graph->node);
+    graph_listener_list_t *cur;
+    graph_index_t i;
+
+    while( (cur = graph->listeners) != NULL ) {
+        graph->listeners = cur->next;
+        (*cur->listener->free)( cur->storage );
+        fmem_free( cur );
+    }
+    if( graph->rows != NULL ) {
+        for( i=0; i<graph->nodes; i++ ) {
+            graphsparse_free( &graph->rows[i] );
+        }
+        fmem_free(graph->rows);
+        fmem_free(graph->members);
+    }
+    graph_release(graph, graph->edges_mem);
+    graph_release(graph, graph->forbidden);
+    graph_release(graph, graph->persistant);
+    fmem_free(graph->active);
+    fmem_free(graph->position);
+    fmem_free(graph->signs);
+    fmem_free(graph->activebits);
+    fmem_free(graph->row1);
+    fmem_free(graph->row2);
+    fmem_free(graph->rowidx);
+    fmem_free(graph->activemask);
+    if( graph->unmap != NULL ) {
+        (*graph->unmap)( graph->map, graph->mapsize );
+    }
     fmem_free(graph);
 }
 
@@ -66,9 +650,51 @@ graph_value_t graph_getValue(   const graph_t *graph,
                                 graph_index_t n1,
                                 graph_index_t n2) {
     ASSERT( n1 != n2 );
-    return graph->edges[GRAPH_EDGE_IDX( n1, n2 ) ];
+    if( graph->layout == GRAPH_LAYOUT_SPARSE ) {
+        return graph_sparseGet( graph, n1, n2 );
+    }
+    return graph_load( graph, GRAPH_POS( graph, n1, n2 ) );
+}
+
+/* Load the row for one layout and width */
+#define GRAPH_ROW_LOOP( _LOAD, _POS ) \
+    for( k=0; k<graph->count; k++ ) { \
+        i = graph->active[k]; \
+        if( i != n ) { \
+            row[i] = _LOAD( graph, _POS( graph, n, i ) ); \
+        } \
+    }
+
+void graph_getRow( const graph_t *graph, graph_index_t n, graph_value_t *row ) {
+    graph_index_t   i;
+    graph_size_t    k;
+
+    if( graph->layout == GRAPH_LAYOUT_SPARSE ) {
+        for( k=0; k<graph->count; k++ ) {
+            i = graph->active[k];
+            if( i != n ) {
+                row[i] = graph_sparseGet( graph, n, i );
+            }
+        }
+    } else if( graph->layout == GRAPH_LAYOUT_SQUARE ) {
+        switch( graph->width ) {
+            case 1:  GRAPH_ROW_LOOP( graph_load1, GRAPH_POS_SQUARE );   break;
+            case 2:  GRAPH_ROW_LOOP( graph_load2, GRAPH_POS_SQUARE );   break;
+            case 4:  GRAPH_ROW_LOOP( graph_load4, GRAPH_POS_SQUARE );   break;
+            default: GRAPH_ROW_LOOP( graph_loadMax, GRAPH_POS_SQUARE ); break;
+        }
+    } else {
+        switch( graph->width ) {
+            case 1:  GRAPH_ROW_LOOP( graph_load1, GRAPH_POS_TRIANGULAR );   break;
+            case 2:  GRAPH_ROW_LOOP( graph_load2, GRAPH_POS_TRIANGULAR );   break;
+            case 4:  GRAPH_ROW_LOOP( graph_load4, GRAPH_POS_TRIANGULAR );   break;
+            default: GRAPH_ROW_LOOP( graph_loadMax, GRAPH_POS_TRIANGULAR ); break;
+        }
+    }
 }
 
+#undef GRAPH_ROW_LOOP
+
 graph_size_t graph_getNodeCount( const graph_t *graph ) {
     return graph->nodes;
 }
@@ -78,7 +704,62 @@ graph_size_t graph_getEdgeCount( const graph_t *graph ) {
 }
 
 graph_index_t graph_getNext( const graph_t *graph, graph_index_t i ) {
-    return graph->node[i];
+    graph_index_t pos;
+
+    ASSERT( graph->active[graph->position[i]] == i );
+    pos = graph->position[i] + 1;
+    return pos < graph->count ? graph->active[pos] : -1;
+}
+
+const graph_index_t *graph_getActive( const graph_t *graph ) {
+    return graph->active;
+}
+
+graph_size_t graph_getActiveCount( const graph_t *graph ) {
+    return graph->count;
+}
+
+/* Remove n from the active nodes by moving the later ones down, so that
+ * the active nodes stay in order of index. O(N), as the merge itself.
+ * Returns the position of n, needed to restore it.
+ */
+static graph_index_t graph_removeNode( graph_t *graph, graph_index_t n ) {
+    graph_index_t pos, k;
+
+    pos = graph->position[n];
+    ASSERT( pos > 0 && graph->active[pos] == n );
+
+    graph->count--;
+    for( k = pos; k < graph->count; k++ ) {
+        graph->active[k] = graph->active[k+1];
+        graph->position[graph->active[k]] = k;
+    }
+    graph->active[graph->count] = n;
+    graph->position[n] = graph->count;
+    if( graph->activemask != NULL ) {
+        graph->activemask[n] = 0;
+    }
+    return pos;
+}
+
+/* Undo graph_removeNode, moving the later nodes up again. The nodes must
+ * be restored in the opposite order of removal.
+ */
+static void graph_restoreNode( graph_t *graph, graph_index_t n, graph_index_t pos ) {
+    graph_index_t k;
+
+    ASSERT( graph->active[graph->count] == n );
+
+    for( k = graph->count; k > pos; k-- ) {
+        graph->active[k] = graph->active[k-1];
+        graph->position[graph->active[k]] = k;
+    }
+    graph->active[pos] = n;
+    graph->position[n] = pos;
+    graph->count++;
+    if( graph->activemask != NULL ) {
+        graph->activemask[n] = -1;
+    }
 }
 
 void graph_setValue( graph_t *graph,
@@ -86,18 +767,128 @@ void graph_setValue( graph_t *graph,
                      graph_index_t n2,
                      graph_value_t val ) {
     ASSERT(n1 != n2);
-    graph->edges[GRAPH_EDGE_IDX(n1,n2)] = val;
+    if( graph->layout == GRAPH_LAYOUT_SPARSE ) {
+        graph_sparseSet( graph, n1, n2, val );
+    } else {
+        graph_storeEdge( graph, n1, n2, val );
+    }
+    if( graph->signs != NULL ) {
+        graph_signSet( graph, n1, n2, val );
+    }
 }
 
 void graph_setAllCosts( graph_t *graph, graph_value_t val ) {
     graph_index_t i, j;
+
+    if( graph->layout == GRAPH_LAYOUT_SPARSE ) {
+        ASSERT( val < 0 ); /* Merged implicit edges must stay non-edges */
+        graph->fill = val;
+        for( i=0; i<graph->nodes; i++ ) {
+            graphsparse_clear( &graph->rows[i] );
+            graph->members[i] = 1;
+            graph->active[i] = i;
+            graph->position[i] = i;
+        }
+        graph->count = graph->nodes;
+        if( graph->signs != NULL ) {
+            graph_signFill( graph );
+        }
+        return;
+    }
+
     for( i=0; i<graph->nodes; i++ ) {
         for( j=i+1; j<graph->nodes; j++ ) {
-            graph->edges[ GRAPH_EDGE_IDX( i, j ) ] = val;
+            graph_setValue( graph, i, j, val );
+        }
+        graph->active[i] = i;
+        graph->position[i] = i;
+        if( graph->activemask != NULL ) {
+            graph->activemask[i] = -1;
         }
-        graph->node[i] = i+1;
     }
-    graph->node[graph->nodes-1] = -1;
+    graph->count = graph->nodes;
+    if( graph->signs != NULL ) {
+        graph_signFill( graph );
+    }
+}
+
+static graph_value_t graph_sparseGet( const graph_t *graph, graph_index_t n1, graph_index_t n2 ) {
+    graph_value_t val;
+
+    if( graphsparse_get( &graph->rows[n1], n2, &val ) ) {
+        return val;
+    }
+    return GRAPH_IMPLICIT( graph, n1, n2 );
+}
+
+static void graph_sparseSet( graph_t *graph, graph_index_t n1, graph_index_t n2, graph_value_t val ) {
+    graph_value_t old;
+
+    /* Only store values that differ from the implicit, or already stored */
+    if( !graphsparse_get( &graph->rows[n1], n2, &old ) && val == GRAPH_IMPLICIT( graph, n1, n2 ) ) {
+        return;
+    }
+    graphsparse_set( &graph->rows[n1], n2, val );
+    graphsparse_set( &graph->rows[n2], n1, val );
+}
+
+/* Gather the values of n1 and n2 to the active nodes stored in either row
+ * into row1, row2 and rowidx. All other pairs of values are implicit, and
+ * thus both negative. Returns the number gathered.
+ */
+static graph_size_t graph_sparseGather( graph_t *graph, graph_index_t n1, graph_index_t n2 ) {
+    const graphsparse_row_t *r1, *r2;
+    graph_value_t val;
+    graph_index_t i;
+    graph_size_t k, n;
+
+    r1 = &graph->rows[n1];
+    r2 = &graph->rows[n2];
+    n = 0;
+    for( k=0; k<=r1->mask; k++ ) {
+        i = r1->key[k];
+        if( i >= 0 && i != n2 && GRAPH_ISACTIVE( graph, i ) ) {
+            graph->rowidx[n] = i;
+            graph->row1[n] = r1->value[k];
+            graph->row2[n] = graph_sparseGet( graph, n2, i );
+            n++;
+        }
+    }
+    for( k=0; k<=r2->mask; k++ ) {
+        i = r2->key[k];
+        if( i >= 0 && i != n1 && GRAPH_ISACTIVE( graph, i ) && !graphsparse_get( r1, i, &val ) ) {
+            graph->rowidx[n] = i;
+            graph->row1[n] = GRAPH_IMPLICIT( graph, n1, i );
+            graph->row2[n] = r2->value[k];
+            n++;
+        }
+    }
+    return n;
+}
+
+/* Merge the n gathered values of row2 into row1, returning the cost as in
+ * graph_apply_merge
+ */
+static graph_cost_t graph_sparseMerge( graph_t *graph, graph_size_t n, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
+    graph_value_t ev1, ev2;
+    graph_cost_t cost = 0;
+    graph_size_t k;
+
+    for( k=0; k<n; k++ ) {
+        ev1 = graph->row1[k];
+        ev2 = graph->row2[k];
+        cost += graph_mergeCost( ev1, ev2, fixpoint, bookkeepingValue );
+        graph->row1[k] = ev1 + ev2;
+    }
+    return cost;
+}
+
+int graph_getLayout( const graph_t *graph ) {
+    return graph->layout;
+}
+
+int graph_getWidth( const graph_t *graph ) {
+    return graph->width;
 }
 
 void graph_chSet_free( graph_chSet_t *chSet ) {
@@ -115,7 +906,7 @@ graph_chSet_t *graph_merge( const graph_t *graph, graph_index_t n1, graph_index_
 
     ASSERT( n1 != n2 );
 
-    chs->func = graph_apply_merge;
+    chs->op = GRAPH_OP_MERGE;
     if( n1 < n2 ) {
         chs->n1 = n1;
         chs->n2 = n2;
@@ -138,7 +929,7 @@ graph_chSet_t *graph_setForbidden( const graph_t *graph, graph_index_t n1, graph
 
     ASSERT( n1 != n2 );
 
-    chs->func = graph_apply_setEdge;
+    chs->op = GRAPH_OP_SETEDGE;
     if( n1 < n2 ) {
         chs->n1 = n1;
         chs->n2 = n2;
@@ -158,7 +949,7 @@ graph_chSet_t *graph_setPersistant( const graph_t *graph, graph_index_t n1, grap
 
     ASSERT( n1 != n2 );
 
-    chs->func = graph_apply_setEdge;
+    chs->op = GRAPH_OP_SETEDGE;
     if( n1 < n2 ) {
         chs->n1 = n1;
         chs->n2 = n2;
@@ -171,158 +962,629 @@ graph_chSet_t *graph_setPersistant( const graph_t *graph, graph_index_t n1, grap
     return chs;
 }
 
+/* Cost of merging two edges of values ev1 and ev2 to a third node */
+static graph_cost_t graph_mergeCost( graph_value_t ev1, graph_value_t ev2, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
+    graph_cost_t cost = 0;
 
+    if( (ev1 < 0) && (ev2 > 0) ) {
+        cost += ( -ev1 < ev2 ? -ev1 : ev2 )*fixpoint;
+    } else if( (ev1 > 0) && (ev2 < 0) ) {
+        cost += ( ev1 < -ev2 ? ev1 : -ev2 )*fixpoint;
+    }
 
-graph_cost_t graph_apply_merge(   graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
-    graph_index_t       edge_idx;
-    graph_index_t       i;
-    graph_index_t       ei1, ei2; /* Edge index */
+    if( ev1 == 0 || ev2 == 0 ) {
+        /* One or two zero-edges resolved, at most one created */
+        cost += bookkeepingValue;
+    } else if( ev1 + ev2 == 0 ) {
+        /* Zero-edge created */
+        cost -= bookkeepingValue;
+    }
+    return cost;
+}
 
-    graph_value_t       ev1, ev2;
+/* Finish merging the row of n2 into n1 from position k of the active list,
+ * after a handler for a narrower width widened the graph
+ */
+static graph_cost_t graph_mergeRest( graph_t *graph, graph_chSet_t *chs, graph_size_t k, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
+    graph_index_t   i;
+    graph_value_t   ev1, ev2;
+    graph_cost_t    cost = 0;
 
-    graph_cost_t        cost;
-    edge_idx = GRAPH_EDGE_IDX( chs->n1, chs->n2 );
+    for( ; k<graph->count; k++ ) {
+        i = graph->active[k];
+        if( i != chs->n1 && i != chs->n2 ) {
+            ev1 = graph_load( graph, GRAPH_POS( graph, chs->n1, i ) );
+            ev2 = graph_load( graph, GRAPH_POS( graph, chs->n2, i ) );
+            cost += graph_mergeCost( ev1, ev2, fixpoint, bookkeepingValue );
+            graph_storeEdge( graph, chs->n1, i, ev1 + ev2 );
+        }
+    }
+    return cost;
+}
 
-    cost = 0;
+/* As graph_mergeRest, for splitting */
+static void graph_splitRest( graph_t *graph, graph_chSet_t *chs, graph_size_t k ) {
+    graph_index_t   i;
 
-    /* If nonedge merging, add cost for it */
-    ev1 = graph->edges[GRAPH_EDGE_IDX(chs->n1, chs->n2)];
-    if( ev1 < 0 ) {
-        cost += -ev1*fixpoint;
-    } else if( ev1 == 0 ) {
-        cost += bookkeepingValue; /* Resolved a zeroedge */
+    for( ; k<graph->count; k++ ) {
+        i = graph->active[k];
+        if( i != chs->n1 ) {
+            graph_storeEdge( graph, chs->n1, i,
+                    graph_load( graph, GRAPH_POS( graph, chs->n1, i ) ) -
+                    graph_load( graph, GRAPH_POS( graph, chs->n2, i ) ) );
+        }
     }
-    
-    /* Merge values, reversable due to storage of n2 */
-    for( i=0; i>=0; i=graph->node[i] ) {
-        if( i != chs->n1 && i != chs->n2 ) {
-            ei1 = GRAPH_EDGE_IDX(chs->n1,i);
-            ei2 = GRAPH_EDGE_IDX(chs->n2,i);
+}
 
-            ev1 = graph->edges[ei1];
-            ev2 = graph->edges[ei2];
+/* Row kernels of square graphs of width 4. Over the n columns set in
+ * mask, add row2 to row1, adding the cost of merging them to *cost, or
+ * subtract it. They stop at the first value, or for AVX2 the first block
+ * of eight, that doesn't fit an int, and return its column, or n if done.
+ */
+static graph_size_t graph_mergeMasked( int *row1, const int *row2, const int *mask, graph_size_t n, graph_cost_t fixpoint, graph_cost_t bookkeepingValue, graph_cost_t *cost ) {
+    graph_size_t    j;
+    graph_value_t   val;
 
-            if( (ev1 < 0) && (ev2 > 0) ) {
-                if( -ev1 < ev2 ) {
-                    cost += -ev1*fixpoint;
-                } else {
-                    cost += ev2*fixpoint;
-                }
-            } else if( (ev1 > 0) && (ev2 < 0) ) {
-                if( ev1 < -ev2 ) {
-                    cost += ev1*fixpoint;
-                } else {
-                    cost += -ev2*fixpoint;
-                }
+    for( j=0; j<n; j++ ) {
+        if( mask[j] ) {
+            val = (graph_value_t)row1[j] + row2[j];
+            if( val < INT_MIN || val > INT_MAX ) {
+                break;
             }
+            *cost += graph_mergeCost( row1[j], row2[j], fixpoint, bookkeepingValue );
+            row1[j] = (int)val;
+        }
+    }
+    return j;
+}
 
-            if( ev1 + ev2 == 0 ) {
-                /* Bookkeeping */
-                if( ev1 == 0 && ev2 == 0 ) {
-                    /* two zero-edges resolved, one created */
-                    cost += bookkeepingValue;
-                } 
-                else {
-                    cost -= bookkeepingValue;
-                }
-            }
-            else if (ev1 == 0 || ev2 == 0) {
-                cost += bookkeepingValue;
-            } 
+static graph_size_t graph_splitMasked( int *row1, const int *row2, const int *mask, graph_size_t n ) {
+    graph_size_t    j;
+    graph_value_t   val;
 
-            graph->edges[ei1] += ev2;
+    for( j=0; j<n; j++ ) {
+        if( mask[j] ) {
+            val = (graph_value_t)row1[j] - row2[j];
+            if( val < INT_MIN || val > INT_MAX ) {
+                break;
+            }
+            row1[j] = (int)val;
         }
     }
+    return j;
+}
+
+#ifdef GRAPH_AVX2
+/* As graph_mergeMasked, eight columns at a time. The cost is linear in the
+ * smaller magnitudes of the pairs of opposite sign and in the counts of
+ * zero-edges resolved and created, which are summed separately.
+ */
+__attribute__((target("avx2")))
+static graph_size_t graph_mergeMaskedAvx2( int *row1, const int *row2, const int *mask, graph_size_t n, graph_cost_t fixpoint, graph_cost_t bookkeepingValue, graph_cost_t *cost ) {
+    __m256i         zero, m, a, b, sum, over, opposite, low, zeros, created, acc;
+    graph_cost_t    lanes[4];
+    graph_size_t    j;
+    long            resolved = 0, made = 0;
+
+    zero = _mm256_setzero_si256();
+    acc = _mm256_setzero_si256();
+    for( j=0; j+8<=n; j+=8 ) {
+        m = _mm256_loadu_si256( (const __m256i *)( mask + j ) );
+        a = _mm256_loadu_si256( (const __m256i *)( row1 + j ) );
+        b = _mm256_and_si256( m, _mm256_loadu_si256( (const __m256i *)( row2 + j ) ) );
+        sum = _mm256_add_epi32( a, b );
+
+        /* The sum overflowed if its sign differs from both. Masked out
+         * columns add 0, so they can't.
+         */
+        over = _mm256_and_si256( _mm256_xor_si256( a, sum ), _mm256_xor_si256( b, sum ) );
+        if( _mm256_movemask_ps( _mm256_castsi256_ps( over ) ) != 0 ) {
+            break;
+        }
+
+        opposite = _mm256_or_si256(
+                _mm256_and_si256( _mm256_cmpgt_epi32( zero, a ), _mm256_cmpgt_epi32( b, zero ) ),
+                _mm256_and_si256( _mm256_cmpgt_epi32( a, zero ), _mm256_cmpgt_epi32( zero, b ) ) );
+        low = _mm256_and_si256( opposite, _mm256_min_epu32( _mm256_abs_epi32( a ), _mm256_abs_epi32( b ) ) );
+        acc = _mm256_add_epi64( acc, _mm256_cvtepu32_epi64( _mm256_castsi256_si128( low ) ) );
+        acc = _mm256_add_epi64( acc, _mm256_cvtepu32_epi64( _mm256_extracti128_si256( low, 1 ) ) );
+
+        zeros = _mm256_and_si256( m, _mm256_or_si256( _mm256_cmpeq_epi32( a, zero ), _mm256_cmpeq_epi32( b, zero ) ) );
+        created = _mm256_andnot_si256( zeros, _mm256_and_si256( m, _mm256_cmpeq_epi32( sum, zero ) ) );
+        resolved += GRAPH_POPCOUNT( (unsigned long)_mm256_movemask_ps( _mm256_castsi256_ps( zeros ) ) );
+        made += GRAPH_POPCOUNT( (unsigned long)_mm256_movemask_ps( _mm256_castsi256_ps( created ) ) );
 
-    /* Skip n2 */
-    i=0;
-    while( graph->node[i] != chs->n2 ) {
-        i = graph->node[i];
+        _mm256_storeu_si256( (__m256i *)( row1 + j ), sum );
     }
-    chs->type_spec.prev = i;
-    graph->node[i] = graph->node[chs->n2];
 
-    /* Update changeset */
-    chs->func = graph_apply_split;
+    _mm256_storeu_si256( (__m256i *)lanes, acc );
+    *cost += ( lanes[0] + lanes[1] + lanes[2] + lanes[3] )*fixpoint + ( resolved - made )*bookkeepingValue;
 
-    return cost;
+    if( j + 8 > n ) {
+        j += graph_mergeMasked( row1 + j, row2 + j, mask + j, n - j, fixpoint, bookkeepingValue, cost );
+    }
+    return j;
 }
 
-graph_cost_t graph_apply_split(   graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
-    graph_index_t       edge_idx;
-    graph_index_t       i;
-    graph_index_t       ei1, ei2; /* Edge index */
+__attribute__((target("avx2")))
+static graph_size_t graph_splitMaskedAvx2( int *row1, const int *row2, const int *mask, graph_size_t n ) {
+    __m256i         a, b, diff, over;
+    graph_size_t    j;
 
-    edge_idx = GRAPH_EDGE_IDX( chs->n1, chs->n2 );
+    for( j=0; j+8<=n; j+=8 ) {
+        a = _mm256_loadu_si256( (const __m256i *)( row1 + j ) );
+        b = _mm256_and_si256( _mm256_loadu_si256( (const __m256i *)( mask + j ) ),
+                _mm256_loadu_si256( (const __m256i *)( row2 + j ) ) );
+        diff = _mm256_sub_epi32( a, b );
 
-    /* Merge values, reversable due to storage of n2 */
-    for( i=0; i>=0; i=graph->node[i] ) {
-        if( i != chs->n1 && i != chs->n2 ) {
-            ei1 = GRAPH_EDGE_IDX(chs->n1,i);
-            ei2 = GRAPH_EDGE_IDX(chs->n2,i);
+        /* The difference overflowed if the signs of a and b differ, and
+         * that of the difference differs from a
+         */
+        over = _mm256_and_si256( _mm256_xor_si256( a, b ), _mm256_xor_si256( a, diff ) );
+        if( _mm256_movemask_ps( _mm256_castsi256_ps( over ) ) != 0 ) {
+            break;
+        }
+        _mm256_storeu_si256( (__m256i *)( row1 + j ), diff );
+    }
 
-            graph->edges[ei1] -= graph->edges[ei2];
+    if( j + 8 > n ) {
+        j += graph_splitMasked( row1 + j, row2 + j, mask + j, n - j );
+    }
+    return j;
+}
+#endif
 
-            /* Can only happen when reversing edits; no need to recalculate */
+/* Store row n1 in the other copy of the square layout, the column of n1,
+ * for the active nodes other than n1 and n2 before node end. Returns the
+ * position in the active list of the first node from end on.
+ */
+static graph_size_t graph_copyIntColumn( graph_t *graph, graph_index_t n1, graph_index_t n2, graph_index_t end ) {
+    int             *edges = (int *)graph->edges;
+    graph_index_t   i;
+    graph_size_t    k;
+
+    for( k=0; k<graph->count && graph->active[k] < end; k++ ) {
+        i = graph->active[k];
+        if( i != n1 && i != n2 ) {
+            edges[i*graph->stride + n1] = edges[n1*graph->stride + i];
         }
     }
+    return k;
+}
 
-    /* Insert n2 in list */
-    graph->node[chs->type_spec.prev] = chs->n2;
+/* Merge or split the rows of n1 and n2 of a square graph of width 4 with
+ * the row kernels, with AVX2 if the processor has it. The columns of n1
+ * and n2 are masked out while doing so. Returns the position in the active
+ * list to go on from, before graph->count if a value didn't fit.
+ */
+static graph_size_t graph_mergeRows( graph_t *graph, graph_index_t n1, graph_index_t n2, graph_cost_t fixpoint, graph_cost_t bookkeepingValue, graph_cost_t *cost ) {
+    int             *row1 = (int *)graph->edges + n1*graph->stride;
+    const int       *row2 = (const int *)graph->edges + n2*graph->stride;
+    graph_size_t    end;
 
-    /* Update changeset */
-    chs->func=graph_apply_merge;
+    graph->activemask[n1] = 0;
+    graph->activemask[n2] = 0;
+#ifdef GRAPH_AVX2
+    if( __builtin_cpu_supports( "avx2" ) ) {
+        end = graph_mergeMaskedAvx2( row1, row2, graph->activemask, graph->nodes, fixpoint, bookkeepingValue, cost );
+    } else {
+        end = graph_mergeMasked( row1, row2, graph->activemask, graph->nodes, fixpoint, bookkeepingValue, cost );
+    }
+#else
+    end = graph_mergeMasked( row1, row2, graph->activemask, graph->nodes, fixpoint, bookkeepingValue, cost );
+#endif
+    graph->activemask[n1] = -1;
+    graph->activemask[n2] = -1;
 
-    return 0; /* Ignore costs here, this is only used for reversing changes... */
+    return graph_copyIntColumn( graph, n1, n2, end );
+}
+
+static graph_size_t graph_splitRows( graph_t *graph, graph_index_t n1, graph_index_t n2 ) {
+    int             *row1 = (int *)graph->edges + n1*graph->stride;
+    const int       *row2 = (const int *)graph->edges + n2*graph->stride;
+    graph_size_t    end;
+
+    graph->activemask[n1] = 0;
+#ifdef GRAPH_AVX2
+    if( __builtin_cpu_supports( "avx2" ) ) {
+        end = graph_splitMaskedAvx2( row1, row2, graph->activemask, graph->nodes );
+    } else {
+        end = graph_splitMasked( row1, row2, graph->activemask, graph->nodes );
+    }
+#else
+    end = graph_splitMasked( row1, row2, graph->activemask, graph->nodes );
+#endif
+    graph->activemask[n1] = -1;
+
+    return graph_copyIntColumn( graph, n1, n2, end );
 }
 
-graph_cost_t graph_apply_setEdge( graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
-    graph_index_t       edge_idx;
-    graph_index_t       old_v, new_v; /* Edge values */
+/* Changeset handlers, generic and specialized for the cost models of the
+ * algorithms, for each dense layout and width. Indexed by GRAPH_OP_*.
+ */
+typedef graph_cost_t (*graph_apply_t)( graph_t *, graph_chSet_t *, graph_cost_t, graph_cost_t );
+
+#define GRAPH_POS_LAYOUT( _G, _N1, _N2 ) GRAPH_POS_TRIANGULAR( _G, _N1, _N2 )
+#define GRAPH_STORE( _G, _N1, _N2, _V ) \
+    GRAPH_PUT( _G, GRAPH_POS_TRIANGULAR( _G, _N1, _N2 ), _V )
+
+#define GRAPH_APPLY( _OP )   graph_apply_ ## _OP
+#define GRAPH_FIXPOINT       fixpoint
+#define GRAPH_BOOKKEEPING    bookkeepingValue
+#include "graph_apply_widths.h"
+#undef GRAPH_APPLY
+#undef GRAPH_FIXPOINT
+#undef GRAPH_BOOKKEEPING
+
+#define GRAPH_APPLY( _OP )   graph_apply_ ## _OP ## _1_0
+#define GRAPH_FIXPOINT       1L
+#define GRAPH_BOOKKEEPING    0L
+#include "graph_apply_widths.h"
+#undef GRAPH_APPLY
+#undef GRAPH_FIXPOINT
+#undef GRAPH_BOOKKEEPING
+
+#define GRAPH_APPLY( _OP )   graph_apply_ ## _OP ## _2_1
+#define GRAPH_FIXPOINT       2L
+#define GRAPH_BOOKKEEPING    1L
+#include "graph_apply_widths.h"
+#undef GRAPH_APPLY
+#undef GRAPH_FIXPOINT
+#undef GRAPH_BOOKKEEPING
+
+#undef GRAPH_POS_LAYOUT
+#undef GRAPH_STORE
+
+/* Both copies; the second store fits if the first did. Rows are
+ * contiguous, for the row kernels.
+ */
+#define GRAPH_ROWS
+#define GRAPH_POS_LAYOUT( _G, _N1, _N2 ) GRAPH_POS_SQUARE( _G, _N1, _N2 )
+#define GRAPH_STORE( _G, _N1, _N2, _V ) \
+    ( GRAPH_PUT( _G, GRAPH_POS_SQUARE( _G, _N1, _N2 ), _V ) && \
+      GRAPH_PUT( _G, GRAPH_POS_SQUARE( _G, _N2, _N1 ), _V ) )
+
+#define GRAPH_APPLY( _OP )   graph_apply_ ## _OP ## _square
+#define GRAPH_FIXPOINT       fixpoint
+#define GRAPH_BOOKKEEPING    bookkeepingValue
+#include "graph_apply_widths.h"
+#undef GRAPH_APPLY
+#undef GRAPH_FIXPOINT
+#undef GRAPH_BOOKKEEPING
+
+#define GRAPH_APPLY( _OP )   graph_apply_ ## _OP ## _square_1_0
+#define GRAPH_FIXPOINT       1L
+#define GRAPH_BOOKKEEPING    0L
+#include "graph_apply_widths.h"
+#undef GRAPH_APPLY
+#undef GRAPH_FIXPOINT
+#undef GRAPH_BOOKKEEPING
+
+#define GRAPH_APPLY( _OP )   graph_apply_ ## _OP ## _square_2_1
+#define GRAPH_FIXPOINT       2L
+#define GRAPH_BOOKKEEPING    1L
+#include "graph_apply_widths.h"
+#undef GRAPH_APPLY
+#undef GRAPH_FIXPOINT
+#undef GRAPH_BOOKKEEPING
+
+#undef GRAPH_ROWS
+#undef GRAPH_POS_LAYOUT
+#undef GRAPH_STORE
 
+/* The sparse layout only touches the stored values, so the cost model
+ * constants gain little, and the generic handlers are used for all.
+ */
+static graph_cost_t graph_apply_merge_sparse( graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
+    graph_size_t        k, n;
+    graph_value_t       ev1;
     graph_cost_t        cost;
 
     cost = 0;
 
-    edge_idx = GRAPH_EDGE_IDX( chs->n1, chs->n2 );
+    /* If nonedge merging, add cost for it */
+    ev1 = graph_sparseGet( graph, chs->n1, chs->n2 );
+    if( ev1 < 0 ) {
+        cost += -ev1*fixpoint;
+    } else if( ev1 == 0 ) {
+        cost += bookkeepingValue; /* Resolved a zeroedge */
+    }
+
+    n = graph_sparseGather( graph, chs->n1, chs->n2 );
+    cost += graph_sparseMerge( graph, n, fixpoint, bookkeepingValue );
+
+    /* Implicit values follows the members */
+    graph->members[chs->n1] += graph->members[chs->n2];
+    for( k=0; k<n; k++ ) {
+        graph_sparseSet( graph, chs->n1, graph->rowidx[k], graph->row1[k] );
+    }
+
+    chs->type_spec.prev = graph_removeNode( graph, chs->n2 );
+    chs->op = GRAPH_OP_SPLIT;
+
+    return cost;
+}
+
+static graph_cost_t graph_apply_split_sparse( graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
+    graph_size_t        k, n;
+
+    (void)fixpoint;
+    (void)bookkeepingValue;
+
+    n = graph_sparseGather( graph, chs->n1, chs->n2 );
+    graph->members[chs->n1] -= graph->members[chs->n2];
+    for( k=0; k<n; k++ ) {
+        graph_sparseSet( graph, chs->n1, graph->rowidx[k], graph->row1[k] - graph->row2[k] );
+    }
+
+    graph_restoreNode( graph, chs->n2, chs->type_spec.prev );
+    chs->op = GRAPH_OP_MERGE;
+
+    return 0; /* Ignore costs here, this is only used for reversing changes... */
+}
+
+static graph_cost_t graph_apply_setEdge_sparse( graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
+    graph_value_t       old_v, new_v;
+    graph_cost_t        cost;
+
+    cost = 0;
 
-    old_v = graph->edges[edge_idx];
+    old_v = graph_sparseGet( graph, chs->n1, chs->n2 );
     new_v = chs->type_spec.value;
-    graph->edges[edge_idx] = new_v;
+    graph_sparseSet( graph, chs->n1, chs->n2, new_v );
     chs->type_spec.value = old_v;
 
-    DBGLONG( 12, old_v );
-    DBGLONG( 12, new_v );
-
     if( old_v<0 && new_v>0 ) {
         cost += -old_v*fixpoint;
     } else if( old_v>0 && new_v<0 ) {
         cost += old_v*fixpoint;
     }
     if( old_v == 0 ) {
-        /* Bookkeeping: Resolving a zero edge */
         cost += bookkeepingValue;
     }
     if( new_v == 0 ) {
-        /* Bookkeeping: Creating a zero edge */
         cost -= bookkeepingValue;
     }
 
     return cost;
 }
 
-graph_cost_t graph_apply( graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
-    return (*chs->func)( graph, chs, fixpoint, bookkeepingValue );
+#define GRAPH_APPLY_ROW( _S ) \
+    { NULL, graph_apply_merge ## _S, graph_apply_split ## _S, graph_apply_setEdge ## _S }
+
+/* Indexed by dense layout, cost model (generic, (1,0), (2,1)), width (1, 2,
+ * 4 and GRAPH_WIDTH_MAX) and operation
+ */
+static const graph_apply_t graph_apply_tables[2][3][4][4] = {
+    {
+        {
+            GRAPH_APPLY_ROW( _w1 ),
+            GRAPH_APPLY_ROW( _w2 ),
+            GRAPH_APPLY_ROW( _w4 ),
+            GRAPH_APPLY_ROW( _wmax )
+        },
+        {
+            GRAPH_APPLY_ROW( _w1_1_0 ),
+            GRAPH_APPLY_ROW( _w2_1_0 ),
+            GRAPH_APPLY_ROW( _w4_1_0 ),
+            GRAPH_APPLY_ROW( _wmax_1_0 )
+        },
+        {
+            GRAPH_APPLY_ROW( _w1_2_1 ),
+            GRAPH_APPLY_ROW( _w2_2_1 ),
+            GRAPH_APPLY_ROW( _w4_2_1 ),
+            GRAPH_APPLY_ROW( _wmax_2_1 )
+        }
+    }, {
+        {
+            GRAPH_APPLY_ROW( _w1_square ),
+            GRAPH_APPLY_ROW( _w2_square ),
+            GRAPH_APPLY_ROW( _w4_square ),
+            GRAPH_APPLY_ROW( _wmax_square )
+        },
+        {
+            GRAPH_APPLY_ROW( _w1_square_1_0 ),
+            GRAPH_APPLY_ROW( _w2_square_1_0 ),
+            GRAPH_APPLY_ROW( _w4_square_1_0 ),
+            GRAPH_APPLY_ROW( _wmax_square_1_0 )
+        },
+        {
+            GRAPH_APPLY_ROW( _w1_square_2_1 ),
+            GRAPH_APPLY_ROW( _w2_square_2_1 ),
+            GRAPH_APPLY_ROW( _w4_square_2_1 ),
+            GRAPH_APPLY_ROW( _wmax_square_2_1 )
+        }
+    }
+};
+
+#undef GRAPH_APPLY_ROW
+
+static const graph_apply_t graph_apply_sparse[4] = {
+    NULL, graph_apply_merge_sparse, graph_apply_split_sparse, graph_apply_setEdge_sparse
+};
+
+/* Indices into the tables of handlers above */
+const graph_model_t graph_model_1_0 = { 1, 0, 1 };
+const graph_model_t graph_model_2_1 = { 2, 1, 2 };
+
+graph_cost_t graph_apply( graph_t *graph, graph_chSet_t *chs, const graph_model_t *model ) {
+    const graph_apply_t *table;
+    graph_listener_list_t *cur;
+    graph_cost_t cost;
+    int op;
+
+    ASSERT( model->handlers >= 0 && model->handlers < 3 );
+    if( graph->layout == GRAPH_LAYOUT_SPARSE ) {
+        table = graph_apply_sparse;
+    } else {
+        table = graph_apply_tables[graph->layout][model->handlers][GRAPH_WIDTH_INDEX( graph->width )];
+    }
+
+    op = chs->op;
+    ASSERT( op >= GRAPH_OP_MERGE && op <= GRAPH_OP_SETEDGE );
+
+    if( graph->listeners == NULL && graph->signs == NULL ) {
+        return (*table[op])( graph, chs, model->fixpoint, model->bookkeeping );
+    }
+
+    for( cur = graph->listeners; cur != NULL; cur = cur->next ) {
+        (*cur->listener->before)( cur->storage, graph, op, chs->n1, chs->n2 );
+    }
+
+    cost = (*table[op])( graph, chs, model->fixpoint, model->bookkeeping );
+
+    /* After a merge n2 is inactive, and only the edges of n1 has changed */
+    if( graph->signs != NULL ) {
+        if( op == GRAPH_OP_MERGE ) {
+            graph->activebits[ chs->n2 / GRAPH_FLAG_BITS ] &= ~GRAPH_FLAG_MASK( chs->n2 );
+            graph_signRow( graph, chs->n1 );
+        } else if( op == GRAPH_OP_SPLIT ) {
+            graph->activebits[ chs->n2 / GRAPH_FLAG_BITS ] |= GRAPH_FLAG_MASK( chs->n2 );
+            graph_signRow( graph, chs->n1 );
+        } else {
+            graph_signSet( graph, chs->n1, chs->n2, graph_getValue( graph, chs->n1, chs->n2 ) );
+        }
+    }
+
+    for( cur = graph->listeners; cur != NULL; cur = cur->next ) {
+        (*cur->listener->after)( cur->storage, graph, op, chs->n1, chs->n2 );
+    }
+
+    return cost;
+}
+
+#if !defined(__GNUC__)
+static int graph_popcount( unsigned long x ) {
+    int n = 0;
+    while( x != 0 ) {
+        x &= x - 1;
+        n++;
+    }
+    return n;
+}
+
+/* Index of the lowest set bit, x must not be 0 */
+static int graph_ctz( unsigned long x ) {
+    int n = 0;
+    while( ( x & 1UL ) == 0 ) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+}
+#endif
+
+/* Set the sign bits of the edge (n1,n2), in both rows */
+static void graph_signSet( graph_t *graph, graph_index_t n1, graph_index_t n2, graph_value_t val ) {
+    int s, sign = GRAPH_SIGNOF( val );
+
+    for( s=-1; s<=1; s++ ) {
+        if( s == sign ) {
+            GRAPH_SIGNROW( graph, s, n1 )[ n2 / GRAPH_FLAG_BITS ] |= GRAPH_FLAG_MASK( n2 );
+            GRAPH_SIGNROW( graph, s, n2 )[ n1 / GRAPH_FLAG_BITS ] |= GRAPH_FLAG_MASK( n1 );
+        } else {
+            GRAPH_SIGNROW( graph, s, n1 )[ n2 / GRAPH_FLAG_BITS ] &= ~GRAPH_FLAG_MASK( n2 );
+            GRAPH_SIGNROW( graph, s, n2 )[ n1 / GRAPH_FLAG_BITS ] &= ~GRAPH_FLAG_MASK( n1 );
+        }
+    }
+}
+
+/* Update the sign bits of all edges from n to active nodes. Bits of
+ * inactive nodes are left as they were, as their edges are unchanged
+ * until they are split again.
+ */
+static void graph_signRow( graph_t *graph, graph_index_t n ) {
+    graph_index_t i;
+    graph_size_t k;
+
+    for( k=0; k<graph->count; k++ ) {
+        i = graph->active[k];
+        if( i != n ) {
+            graph_signSet( graph, n, i, graph_getValue( graph, n, i ) );
+        }
+    }
+}
+
+static void graph_signFill( graph_t *graph ) {
+    graph_index_t i;
+    graph_size_t k;
+
+    memset( graph->signs, 0, sizeof(unsigned long)*3*graph->nodes*graph->words );
+    memset( graph->activebits, 0, sizeof(unsigned long)*graph->words );
+    for( k=0; k<graph->count; k++ ) {
+        i = graph->active[k];
+        graph->activebits[ i / GRAPH_FLAG_BITS ] |= GRAPH_FLAG_MASK( i );
+        graph_signRow( graph, i );
+    }
+}
+
+void graph_enableSigns( graph_t *graph ) {
+    if( graph->signs != NULL || graph->nodes == 0 ) {
+        return;
+    }
+    graph->signs = fmem_alloc_arr( sizeof(unsigned long), 3*graph->nodes*graph->words );
+    graph->activebits = fmem_alloc_arr( sizeof(unsigned long), graph->words );
+    graph_signFill( graph );
+}
+
+int graph_hasSigns( const graph_t *graph ) {
+    return graph->signs != NULL;
+}
+
+graph_size_t graph_countSigns( const graph_t *graph, graph_index_t a, int sa, graph_index_t b, int sb ) {
+    const unsigned long *rowa, *rowb;
+    graph_size_t w, n = 0;
+
+    ASSERT( graph->signs != NULL );
+    rowa = GRAPH_SIGNROW( graph, sa, a );
+    rowb = GRAPH_SIGNROW( graph, sb, b );
+
+    /* The diagonal is never set, so a and b are never counted */
+    for( w=0; w<graph->words; w++ ) {
+        n += GRAPH_POPCOUNT( rowa[w] & rowb[w] & graph->activebits[w] );
+    }
+    return n;
+}
+
+graph_index_t graph_firstSigns( const graph_t *graph, graph_index_t a, int sa, graph_index_t b, int sb ) {
+    const unsigned long *rowa, *rowb;
+    unsigned long bits;
+    graph_size_t w;
+
+    ASSERT( graph->signs != NULL );
+    rowa = GRAPH_SIGNROW( graph, sa, a );
+    rowb = GRAPH_SIGNROW( graph, sb, b );
+
+    for( w=0; w<graph->words; w++ ) {
+        bits = rowa[w] & rowb[w] & graph->activebits[w];
+        if( bits != 0 ) {
+            return w*GRAPH_FLAG_BITS + GRAPH_CTZ( bits );
+        }
+    }
+    return -1;
 }
 
 int graph_isClusterGraph( const graph_t *g){
     int n1, n2, n3;
-    
+
+    if( g->signs != NULL ) {
+        for (n1 = 0; n1 >= 0; n1 = graph_getNext(g, n1) ){
+            for (n2 = graph_getNext(g, n1); n2 >= 0; n2 = graph_getNext(g, n2) ){
+                if(     graph_getValue( g, n1, n2 ) < 0 &&
+                        graph_countSigns( g, n1, 1, n2, 1 ) > 0 ) {
+                    return 0;
+                }
+            }
+        }
+        return 1;
+    }
+
     for (n1 = 0; n1 >= 0; n1 = graph_getNext(g, n1) ){
         for (n2=graph_getNext(g, n1); n2>= 0; n2 = graph_getNext(g, n2) ){
             if( graph_getValue( g, n1, n2 ) < 0 ) {
-                for (n3=graph_getNext(g, n2); n3 >= 0; n3 = graph_getNext(g, n3) ){
-                    if(     graph_getValue( g, n1, n3 ) > 0 &&
+                for (n3 = 0; n3 >= 0; n3 = graph_getNext(g, n3) ){
+                    if(     n3 != n1 && n3 != n2 &&
+                            graph_getValue( g, n1, n3 ) > 0 &&
                             graph_getValue( g, n2, n3 ) > 0 ) {
                         return 0;
                     }
@@ -333,3 +1595,23 @@ int graph_isClusterGraph( const graph_t *g){
     return 1;
 }
 
+void graph_addListener( graph_t *graph, const graph_listener_t *listener, void *storage ) {
+    graph_listener_list_t *cur;
+
+    cur = fmem_alloc( sizeof( graph_listener_list_t ) );
+    cur->listener = listener;
+    cur->storage = storage;
+    cur->next = graph->listeners;
+    graph->listeners = cur;
+}
+
+void *graph_getListener( const graph_t *graph, const graph_listener_t *listener, int n ) {
+    graph_listener_list_t *cur;
+
+    for( cur = graph->listeners; cur != NULL; cur = cur->next ) {
+        if( cur->listener == listener && n-- == 0 ) {
+            return cur->storage;
+        }
+    }
+    return NULL;
+}
@@ -18,12 +18,18 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include <stdio.h>
+#include <stddef.h>
 #include "debug.h"
 
 /* TODO: Make nicer */
 #define GRAPH_VALUE_FORBIDDEN  (-100000L)
 #define GRAPH_VALUE_PERSISTANT ( 100000L)
 
+/* Decided edges, also after being merged with an undecided edge */
+#define GRAPH_ISFORBIDDEN( _V )  ( (_V) <= GRAPH_VALUE_FORBIDDEN/2 )
+#define GRAPH_ISPERSISTANT( _V ) ( (_V) >= GRAPH_VALUE_PERSISTANT/2 )
+
 #define GRAPH_EDGE_IDX(n1,n2) ( (n1)<(n2) ? (((n2)*((n2)-1) >> 1)+(n1)) : (((n1)*((n1)-1) >> 1) + (n2)) )
 
 typedef long graph_index_t;
@@ -33,13 +39,91 @@ typedef graph_value_t graph_cost_t;
 
 typedef graph_index_t graph_size_t;
 
+/* Largest node count, so that the sizes of the edge storage of a graph, in
+ * bytes, fit in a long
+ */
+#define GRAPH_NODES_MAX ( 1L << ( sizeof( long ) * 4 - 3 ) )
+
 
 /* TODO: edges var needed? */ 
 
+typedef struct graph_listener_list_t graph_listener_list_t;
+typedef struct graphsparse_row_t graphsparse_row_t;
+
+/* Storage layouts of the edge values.
+ * Triangular stores each edge once, indexed by GRAPH_EDGE_IDX. Square
+ * stores a full symmetric matrix with aligned, padded rows, so that rows
+ * are contiguous, at twice the memory. Sparse only stores the edges that
+ * differ from an implicit negative fill value, in hashed rows, so memory
+ * is proportional to the number of edges. Only the graph is sparse: the
+ * kernel and the algorithms keep tables of all pairs of nodes, so sparse
+ * graphs are only solved up to SOLVE_SPARSE_NODES_MAX nodes, see solve.h.
+ */
+#define GRAPH_LAYOUT_TRIANGULAR 0
+#define GRAPH_LAYOUT_SQUARE     1
+#define GRAPH_LAYOUT_SPARSE     2
+#define GRAPH_LAYOUTS           3
+
+#ifndef GRAPH_LAYOUT_DEFAULT
+#define GRAPH_LAYOUT_DEFAULT GRAPH_LAYOUT_TRIANGULAR
+#endif
+
+/* Bytes per stored edge value: 1, 2, 4 or GRAPH_WIDTH_MAX.
+ * A graph starts at its default width and is widened when a value doesn't
+ * fit, so the width follows the range of the weights. Below 4 bytes, the
+ * decided edges are stored as the offset from their sentinel and a bit in
+ * the forbidden or persistant bitmap.
+ */
+#define GRAPH_WIDTH_MAX ( (int)sizeof( graph_value_t ) )
+
+#ifndef GRAPH_WIDTH_DEFAULT
+#define GRAPH_WIDTH_DEFAULT 1
+#endif
+
 typedef struct graph_t {
     graph_size_t    nodes;
-    graph_value_t   *edges;
-    graph_index_t   *node;
+    void            *edges;     /* Values of width bytes */
+    int             width;
+    graph_size_t    size;       /* Number of values stored */
+    unsigned long   *forbidden; /* Flag bitmaps by position, if width < 4 */
+    unsigned long   *persistant;
+    int             layout;
+    graph_size_t    stride;     /* Row length, when square */
+    void            *edges_mem; /* Allocated block containing edges */
+
+    /* Sparse layout. The implicit value between two nodes is the fill
+     * value times the number of original nodes merged into each, which is
+     * preserved by merging.
+     */
+    graphsparse_row_t *rows;
+    graph_size_t    *members;
+    graph_value_t   fill;
+
+    graph_index_t   *active;    /* Active nodes in order of index */
+    graph_index_t   *position;  /* Index in active, by node */
+    graph_size_t    count;      /* Number of active nodes */
+    graph_listener_list_t *listeners;
+
+    /* Optional sign planes, NULL unless enabled by graph_enableSigns */
+    unsigned long   *signs;     /* Bit matrices of negative, zero and positive edges */
+    unsigned long   *activebits;
+    graph_size_t    words;      /* Words per row of a plane */
+
+    /* Scratch rows for sparse merging, indexed by position in the gather,
+     * NULL in the other layouts */
+    graph_value_t   *row1;
+    graph_value_t   *row2;
+    graph_index_t   *rowidx;
+
+    /* Square layout: -1 for active nodes and 0 for the others, the mask of
+     * the columns to merge for the row kernels. NULL in the other layouts.
+     */
+    int             *activemask;
+
+    /* File the storage is mapped from, if created by graph_createMapped */
+    void            *map;
+    size_t          mapsize;
+    void            (*unmap)( void *, size_t );
 #if DEBUG
     int state_last; /* Enumerate changesets to test for implementation errors */
     int state_current;
@@ -48,14 +132,18 @@ typedef struct graph_t {
 
 typedef struct graph_chSet_t graph_chSet_t;
 
+/* Operations of changesets, also reported to listeners */
+#define GRAPH_OP_MERGE   1
+#define GRAPH_OP_SPLIT   2
+#define GRAPH_OP_SETEDGE 3
+
 struct graph_chSet_t {
-                                    /* Function to apply changeset */
-    graph_cost_t (*func)( graph_t *, graph_chSet_t *, graph_cost_t, graph_cost_t );
+    int                 op;         /* Operation to apply, GRAPH_OP_* */
 
     graph_index_t       n1, n2;     /* Nodes involved in changeset */
     union {
         graph_value_t       value;      /* When setedge, New value of edge, when setedge */
-        graph_index_t       prev;       /* When merged, contains previous node to n2 */
+        graph_index_t       prev;       /* When merged, contains position of n2 in active */
     } type_spec;
 #if DEBUG
     int state_id;
@@ -63,23 +151,108 @@ struct graph_chSet_t {
 #endif
 };
 
+/* Listeners are notified before and after every changeset is applied, so
+ * that data derived from the graph can be updated incrementally instead of
+ * recalculated. Before a merge n2 is still active; after it n2 is removed.
+ */
+typedef struct graph_listener_t {
+    /* Storage, Graph, Operation, Nodes involved */
+    void (*before)( void *, const graph_t *, int, graph_index_t, graph_index_t );
+    void (*after)( void *, const graph_t *, int, graph_index_t, graph_index_t );
+    /* Storage, called from graph_free */
+    void (*free)( void * );
+} graph_listener_t;
+
+struct graph_listener_list_t {
+    const graph_listener_t *listener;
+    void *storage;
+    graph_listener_list_t *next;
+};
+
+/* Layout of graphs created from now on, GRAPH_LAYOUT_DEFAULT initially */
+void graph_setDefaultLayout( int layout );
+
+/* Initial width of graphs created from now on, GRAPH_WIDTH_DEFAULT initially */
+void graph_setDefaultWidth( int width );
+
 graph_t *graph_create( graph_size_t nodes );
 
 void graph_free( graph_t *graph );
 
+/* Binary files hold the edge storage of a triangular or square graph as
+ * is, so that loading doesn't touch the edges. Only graphs with all nodes
+ * active can be written. Returns 0 on failure.
+ */
+int graph_writeBinary( const graph_t *graph, FILE *fp );
+
+/* If data starts like a binary file */
+int graph_isBinary( const void *data, size_t size );
+
+/* Graph using the binary file in data in place, or NULL if the file isn't
+ * valid for this build. Edits write into data, so it should be a private
+ * writable mapping. unmap, if not NULL, is called by graph_free to release
+ * data. Values widened past the width of the file are moved to memory.
+ */
+graph_t *graph_createMapped( void *data, size_t size, void (*unmap)( void *, size_t ) );
+
 graph_value_t graph_getValue( const graph_t *graph, graph_index_t n1, graph_index_t n2 );
 
+/* Store the values of the edges from n to every other active node in row,
+ * indexed by node. Faster than graph_getValue for each, as the layout and
+ * width are only looked at once.
+ */
+void graph_getRow( const graph_t *graph, graph_index_t n, graph_value_t *row );
+
 graph_size_t graph_getNodeCount( const graph_t *graph );
 graph_size_t graph_getEdgeCount( const graph_t *graph );
 
+/* Next active node after the active node i, or -1. Iterating from 0
+ * visits all active nodes in order of index.
+ */
 graph_index_t graph_getNext( const graph_t *graph, graph_index_t i );
 
+/* The active nodes as an array in order of index, for loops over
+ * positions
+ */
+const graph_index_t *graph_getActive( const graph_t *graph );
+graph_size_t graph_getActiveCount( const graph_t *graph );
+
 void graph_setValue( graph_t *graph, graph_index_t n1, graph_index_t n2, graph_value_t val );
 
 void graph_setAllCosts( graph_t *graph, graph_value_t val );
 
+int graph_getLayout( const graph_t *graph );
+
+int graph_getWidth( const graph_t *graph );
+
+/* Keep bit matrices of the signs of all edges, updated by every changeset,
+ * so that sign tests are done on a word of nodes at a time. Costs 3*N^2
+ * bits and O(N) per changeset. Does nothing if already enabled.
+ */
+void graph_enableSigns( graph_t *graph );
+int graph_hasSigns( const graph_t *graph );
+
+/* Number of active nodes c where the signs (-1, 0 or 1) of (a,c) and (b,c)
+ * are sa and sb. The sign planes must be enabled.
+ */
+graph_size_t graph_countSigns( const graph_t *graph, graph_index_t a, int sa, graph_index_t b, int sb );
+
+/* Lowest active node c where the signs of (a,c) and (b,c) are sa and sb,
+ * or -1. In O(N/64), a word of nodes at a time.
+ */
+graph_index_t graph_firstSigns( const graph_t *graph, graph_index_t a, int sa, graph_index_t b, int sb );
+
+/* No triple with (a,b) negative and (a,c), (b,c) positive */
 int graph_isClusterGraph( const graph_t *graph);
 
+/* Register storage to be notified through listener. Ownership of storage
+ * is passed to the graph.
+ */
+void graph_addListener( graph_t *graph, const graph_listener_t *listener, void *storage );
+
+/* Fetch the n:th storage registered with listener, or NULL */
+void *graph_getListener( const graph_t *graph, const graph_listener_t *listener, int n );
+
 
 /* changeset handling.
  * Doesn't modify graph itself. (exception: debug counter)
@@ -89,19 +262,26 @@ graph_chSet_t *graph_setForbidden(  const graph_t *graph, graph_index_t n1, grap
 graph_chSet_t *graph_setPersistant( const graph_t *graph, graph_index_t n1, graph_index_t n2 );
 void graph_chSet_free( graph_chSet_t *chSet );
 
+/* Cost model of an algorithm: an edited edge costs fixpoint times its
+ * value, and a resolved zero-edge costs bookkeeping. handlers selects the
+ * changeset handlers with the constants folded in; 0 selects the generic
+ * ones, which works for any constants.
+ */
+typedef struct graph_model_t {
+    graph_cost_t    fixpoint;
+    graph_cost_t    bookkeeping;
+    int             handlers;
+} graph_model_t;
+
+/* The models of 2.62k and 3k, and of 2k */
+extern const graph_model_t graph_model_1_0;
+extern const graph_model_t graph_model_2_1;
+
 /* Apply changeset
  * changeset is changed to it's inverse.
  * When DEBUG is set, check that changesets apply to correct state
  */
-graph_cost_t graph_apply( graph_t *graph, graph_chSet_t *changeset, graph_cost_t fixpoint, graph_cost_t bookkeepingValue );
-
-
-/* Internal chSet handlers: DO NOT CALL DIRECTLY */
-
-graph_cost_t graph_apply_merge(   graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue );
-graph_cost_t graph_apply_split(   graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue );
-graph_cost_t graph_apply_setEdge( graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue );
-
+graph_cost_t graph_apply( graph_t *graph, graph_chSet_t *changeset, const graph_model_t *model );
 
 #endif
 
@@ -0,0 +1,176 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/* Template for the functions applying changesets, included from
+ * graph_apply_widths.h once per layout, cost model and width, so the
+ * compiler can fold the constants in the inner loops. No include guard.
+ *
+ * GRAPH_HANDLER( op ) : Name of the function for op
+ * GRAPH_FIXPOINT      : Cost multiplier for edited edges
+ * GRAPH_BOOKKEEPING   : Cost for resolving a zero-edge
+ * GRAPH_LOAD( g, pos )             : Value at pos, for the width
+ * GRAPH_POS_LAYOUT( g, a, b )      : Position of the edge, for the layout
+ * GRAPH_STORE( g, a, b, val )      : Store edge value, in all copies; 0 if
+ *                                    it doesn't fit the width
+ * GRAPH_ROWS                       : Defined if rows are contiguous
+ * GRAPH_INTS                       : Defined if values are stored as ints
+ *
+ * With both of the last, whole rows are merged and split by the row
+ * kernels, graph_mergeRows and graph_splitRows, unless few nodes are
+ * active. The active list is walked for the rest, if a value didn't fit.
+ *
+ * A value that doesn't fit widens the graph, and the rest of the changeset
+ * is finished by the generic graph_mergeRest or graph_splitRest.
+ *
+ * The fixpoint and bookkeepingValue arguments are only used if the macros
+ * are defined to them, or by the fallbacks, and are otherwise cast to void.
+ */
+
+#define GRAPH_EDGE( _G, _N1, _N2 ) GRAPH_LOAD( _G, GRAPH_POS_LAYOUT( _G, _N1, _N2 ) )
+
+#if defined(GRAPH_ROWS) && defined(GRAPH_INTS)
+#define GRAPH_KERNELS
+#endif
+
+static graph_cost_t GRAPH_HANDLER( merge )(   graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue );
+static graph_cost_t GRAPH_HANDLER( split )(   graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue );
+static graph_cost_t GRAPH_HANDLER( setEdge )( graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue );
+
+static graph_cost_t GRAPH_HANDLER( merge )( graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
+    graph_index_t       i;
+    graph_size_t        k;
+
+    graph_value_t       ev1, ev2;
+
+    graph_cost_t        cost;
+    cost = 0;
+
+    /* If nonedge merging, add cost for it */
+    ev1 = GRAPH_EDGE( graph, chs->n1, chs->n2 );
+    if( ev1 < 0 ) {
+        cost += -ev1*GRAPH_FIXPOINT;
+    } else if( ev1 == 0 ) {
+        cost += GRAPH_BOOKKEEPING; /* Resolved a zeroedge */
+    }
+
+    /* Merge values, reversable due to storage of n2 */
+    k = 0;
+#ifdef GRAPH_KERNELS
+    if( GRAPH_ROWS_DENSE( graph ) ) {
+        k = graph_mergeRows( graph, chs->n1, chs->n2, GRAPH_FIXPOINT, GRAPH_BOOKKEEPING, &cost );
+    }
+#endif
+    for( ; k<graph->count; k++ ) {
+        i = graph->active[k];
+        if( i != chs->n1 && i != chs->n2 ) {
+            ev1 = GRAPH_EDGE( graph, chs->n1, i );
+            ev2 = GRAPH_EDGE( graph, chs->n2, i );
+            cost += graph_mergeCost( ev1, ev2, GRAPH_FIXPOINT, GRAPH_BOOKKEEPING );
+
+            if( !GRAPH_STORE( graph, chs->n1, i, ev1 + ev2 ) ) {
+                graph_storeEdge( graph, chs->n1, i, ev1 + ev2 );
+                cost += graph_mergeRest( graph, chs, k + 1, fixpoint, bookkeepingValue );
+                break;
+            }
+        }
+    }
+
+    chs->type_spec.prev = graph_removeNode( graph, chs->n2 );
+
+    /* Update changeset */
+    chs->op = GRAPH_OP_SPLIT;
+
+    return cost;
+}
+
+static graph_cost_t GRAPH_HANDLER( split )( graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
+    graph_index_t       i;
+    graph_size_t        k;
+    graph_value_t       val;
+
+    (void)fixpoint;
+    (void)bookkeepingValue;
+
+    /* Unmerge values, n2 is not active */
+    k = 0;
+#ifdef GRAPH_KERNELS
+    if( GRAPH_ROWS_DENSE( graph ) ) {
+        k = graph_splitRows( graph, chs->n1, chs->n2 );
+    }
+#endif
+    for( ; k<graph->count; k++ ) {
+        i = graph->active[k];
+        if( i != chs->n1 ) {
+            /* Can only happen when reversing edits; no need to recalculate */
+            val = GRAPH_EDGE( graph, chs->n1, i ) - GRAPH_EDGE( graph, chs->n2, i );
+            if( !GRAPH_STORE( graph, chs->n1, i, val ) ) {
+                graph_storeEdge( graph, chs->n1, i, val );
+                graph_splitRest( graph, chs, k + 1 );
+                break;
+            }
+        }
+    }
+
+    /* Insert n2 where it was */
+    graph_restoreNode( graph, chs->n2, chs->type_spec.prev );
+
+    /* Update changeset */
+    chs->op = GRAPH_OP_MERGE;
+
+    return 0; /* Ignore costs here, this is only used for reversing changes... */
+}
+
+static graph_cost_t GRAPH_HANDLER( setEdge )( graph_t *graph, graph_chSet_t *chs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
+    graph_index_t       old_v, new_v; /* Edge values */
+
+    graph_cost_t        cost;
+
+    (void)fixpoint;
+    (void)bookkeepingValue;
+
+    cost = 0;
+
+    old_v = GRAPH_EDGE( graph, chs->n1, chs->n2 );
+    new_v = chs->type_spec.value;
+    if( !GRAPH_STORE( graph, chs->n1, chs->n2, new_v ) ) {
+        graph_storeEdge( graph, chs->n1, chs->n2, new_v );
+    }
+    chs->type_spec.value = old_v;
+
+    DBGLONG( 12, old_v );
+    DBGLONG( 12, new_v );
+
+    if( old_v<0 && new_v>0 ) {
+        cost += -old_v*GRAPH_FIXPOINT;
+    } else if( old_v>0 && new_v<0 ) {
+        cost += old_v*GRAPH_FIXPOINT;
+    }
+    if( old_v == 0 ) {
+        /* Bookkeeping: Resolving a zero edge */
+        cost += GRAPH_BOOKKEEPING;
+    }
+    if( new_v == 0 ) {
+        /* Bookkeeping: Creating a zero edge */
+        cost -= GRAPH_BOOKKEEPING;
+    }
+
+    return cost;
+}
+
+#undef GRAPH_EDGE
+#undef GRAPH_KERNELS
@@ -0,0 +1,63 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/* Instantiates graph_apply.h once per width, included from graph.c for each
+ * layout and cost model, so the width is picked once per changeset instead
+ * of at every edge access. No include guard.
+ *
+ * Defines for graph_apply.h:
+ * GRAPH_HANDLER( op ) : Name of the function for op, GRAPH_APPLY with a
+ *                       width suffix
+ * GRAPH_LOAD( g, pos )        : Value at pos
+ * GRAPH_PUT( g, pos, val )    : Store val at pos, 0 if it doesn't fit
+ * GRAPH_INTS                  : Defined for width 4
+ */
+
+#define GRAPH_HANDLER( _OP )        GRAPH_APPLY( _OP ## _w1 )
+#define GRAPH_LOAD( _G, _P )        graph_load1( _G, _P )
+#define GRAPH_PUT( _G, _P, _V )     graph_put1( _G, _P, _V )
+#include "graph_apply.h"
+#undef GRAPH_HANDLER
+#undef GRAPH_LOAD
+#undef GRAPH_PUT
+
+#define GRAPH_HANDLER( _OP )        GRAPH_APPLY( _OP ## _w2 )
+#define GRAPH_LOAD( _G, _P )        graph_load2( _G, _P )
+#define GRAPH_PUT( _G, _P, _V )     graph_put2( _G, _P, _V )
+#include "graph_apply.h"
+#undef GRAPH_HANDLER
+#undef GRAPH_LOAD
+#undef GRAPH_PUT
+
+#define GRAPH_HANDLER( _OP )        GRAPH_APPLY( _OP ## _w4 )
+#define GRAPH_LOAD( _G, _P )        graph_load4( _G, _P )
+#define GRAPH_PUT( _G, _P, _V )     graph_put4( _G, _P, _V )
+#define GRAPH_INTS
+#include "graph_apply.h"
+#undef GRAPH_HANDLER
+#undef GRAPH_LOAD
+#undef GRAPH_PUT
+#undef GRAPH_INTS
+
+#define GRAPH_HANDLER( _OP )        GRAPH_APPLY( _OP ## _wmax )
+#define GRAPH_LOAD( _G, _P )        graph_loadMax( _G, _P )
+#define GRAPH_PUT( _G, _P, _V )     graph_putMax( _G, _P, _V )
+#include "graph_apply.h"
+#undef GRAPH_HANDLER
+#undef GRAPH_LOAD
+#undef GRAPH_PUT
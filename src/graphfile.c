@@ -18,82 +18,407 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include "debug.h"
+#include "fmem.h"
 #include "graphfile.h"
+#include "pacefile.h"
+#include "outbuf.h"
 
-int graphfile_parseline( char *line, int *elems, int length );
+#ifndef GRAPHFILE_THREADS_DEFAULT
+#define GRAPHFILE_THREADS_DEFAULT 4
+#endif
 
+#define GRAPHFILE_THREADS_MAX 64
 
+/* Bytes parsed by a thread at a time. The edges of a batch of chunks are
+ * stored in the graph before the next batch is parsed, which bounds the
+ * memory for parsed edges.
+ */
+#define GRAPHFILE_CHUNK ( 1L << 20 )
 
-int graphfile_parseline( char *line, int *elems, int length ) {
-    char *tok;
-    int i;
+/* Numbers kept from a line; longer lines are errors */
+#define GRAPHFILE_LINE_MAX 4
 
-    /* TODO: strtok isn't thread safe */
-    tok = strtok( line, " \t\n" );
+typedef struct graphfile_edge_t {
+    graph_index_t   n1, n2;
+    graph_value_t   val;
+} graphfile_edge_t;
 
-    for( i=0; i<length && tok; i++ ) {
-        elems[i] = atoi( tok );
-        tok = strtok( NULL, " \t\n" );
-    }
-    return i;
+typedef struct graphfile_error_t {
+    long            line;       /* Within the chunk, from 0 */
+    const char      *msg;
+} graphfile_error_t;
+
+struct graphfile_stream_t {
+    char                *data;
+    size_t              size;
+    int                 mapped;
+    const char          *pos;
+};
+
+typedef struct graphfile_chunk_t {
+    const char          *begin, *end;
+    graph_size_t        nodes;
+
+    long                lines;
+    graphfile_edge_t    *edge;
+    long                edges, size;
+    graphfile_error_t   *error;
+    long                errors, errsize;
+} graphfile_chunk_t;
+
+static int graphfile_threads = GRAPHFILE_THREADS_DEFAULT;
+static graph_size_t graphfile_maxnodes = GRAPH_NODES_MAX;
+
+int graphfile_scanline( const char **pos, const char *end, long *vals, int length );
+void graphfile_addEdge( graphfile_chunk_t *chunk, long n1, long n2, long val );
+void graphfile_addError( graphfile_chunk_t *chunk, const char *msg );
+void *graphfile_parsechunk( void *arg );
+int graphfile_split( graphfile_chunk_t *chunk, const char **pos, const char *end );
+void graphfile_store( graph_t *graph, graphfile_chunk_t *chunk, int used, long *line );
+graph_t *graphfile_parse( const char *data, size_t size );
+graph_t *graphfile_createMapped( void *data, size_t size, void (*unmap)( void *, size_t ) );
+void graphfile_unmap( void *data, size_t size );
+void graphfile_freebuffer( void *data, size_t size );
+char *graphfile_slurp( FILE *fp, size_t *len );
+const char *graphfile_nextgraph( const char *begin, const char *end, int pace );
+
+
+void graphfile_setThreads( int threads ) {
+    ASSERT( threads > 0 );
+    graphfile_threads = threads < GRAPHFILE_THREADS_MAX ? threads : GRAPHFILE_THREADS_MAX;
+}
+
+void graphfile_setMaxNodes( graph_size_t nodes ) {
+    ASSERT( nodes > 0 );
+    graphfile_maxnodes = nodes < GRAPH_NODES_MAX ? nodes : GRAPH_NODES_MAX;
 }
 
+graph_size_t graphfile_getMaxNodes( void ) {
+    return graphfile_maxnodes;
+}
 
-graph_t *graphfile_readfobj( FILE *fp ) {
-    char line[1024];
-    int elems[32];
-    int cnt, nodecnt;
-    int i, j;
+/* Scan the integers of the line at *pos, leaving *pos at the next line.
+ * Returns the number of integers, up to length are stored, or -1 if the
+ * line has anything else in it.
+ */
+int graphfile_scanline( const char **pos, const char *end, long *vals, int length ) {
+    const char *p = *pos;
+    int cnt = 0, neg, bad = 0;
+    long val;
 
-    graph_t *graph = NULL;
+    while( p < end && *p != '\n' ) {
+        if( *p == ' ' || *p == '\t' || *p == '\r' ) {
+            p++;
+            continue;
+        }
 
-    /* Fetch header */
-    if( !fgets( line, 1024, fp ) ) {
-        return NULL;
+        neg = 0;
+        if( *p == '-' || *p == '+' ) {
+            neg = *p == '-';
+            p++;
+        }
+        if( p == end || *p < '0' || *p > '9' ) {
+            bad = 1;
+        }
+        val = 0;
+        while( p < end && *p >= '0' && *p <= '9' ) {
+            if( !bad && val > ( LONG_MAX - ( *p - '0' ) ) / 10 ) {
+                bad = 1;
+            }
+            if( !bad ) {
+                val = val * 10 + ( *p - '0' );
+            }
+            p++;
+        }
+        if( p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n' ) {
+            bad = 1;
+        }
+
+        if( bad ) {
+            while( p < end && *p != '\n' ) {
+                p++;
+            }
+            break;
+        }
+        if( cnt < length ) {
+            vals[cnt] = neg ? -val : val;
+        }
+        cnt++;
     }
 
-    /* Parse header */
-    cnt = graphfile_parseline( line, elems, 32 );
+    *pos = p < end ? p + 1 : p;
+    return bad ? -1 : cnt;
+}
 
-    if( cnt == 1 ) {
-        nodecnt = elems[0];
-        graph = graph_create( nodecnt );
-    } else {
-        DBGSTR( 0, line );
-        return NULL;
+void graphfile_addEdge( graphfile_chunk_t *chunk, long n1, long n2, long val ) {
+    graphfile_edge_t *edge;
+
+    if( chunk->edges == chunk->size ) {
+        chunk->size = chunk->size ? chunk->size * 2 : 4096;
+        edge = fmem_alloc_arr( sizeof( graphfile_edge_t ), chunk->size );
+        if( chunk->edges > 0 ) {
+            memcpy( edge, chunk->edge, sizeof( graphfile_edge_t ) * chunk->edges );
+        }
+        fmem_free( chunk->edge );
+        chunk->edge = edge;
     }
+    edge = &chunk->edge[chunk->edges++];
+    edge->n1 = n1;
+    edge->n2 = n2;
+    edge->val = val;
+}
 
-    /* Update all edges to be non-edges, needed for unweighted files */
+void graphfile_addError( graphfile_chunk_t *chunk, const char *msg ) {
+    graphfile_error_t *error;
 
-    /* TODO: better way to implement this? */
-    for( i=0; i<nodecnt; i++ ) {
-        for( j=i+1; j<nodecnt; j++ ) {
-            graph_setValue( graph, i, j, -1 );
+    if( chunk->errors == chunk->errsize ) {
+        chunk->errsize = chunk->errsize ? chunk->errsize * 2 : 16;
+        error = fmem_alloc_arr( sizeof( graphfile_error_t ), chunk->errsize );
+        if( chunk->errors > 0 ) {
+            memcpy( error, chunk->error, sizeof( graphfile_error_t ) * chunk->errors );
         }
+        fmem_free( chunk->error );
+        chunk->error = error;
     }
+    error = &chunk->error[chunk->errors++];
+    error->line = chunk->lines;
+    error->msg = msg;
+}
 
-    /* Fetch rest */
-    while( NULL != fgets( line, 1024, fp ) ) {
-        /* Parse rest */
-        cnt = graphfile_parseline( line, elems, 32 );
+void *graphfile_parsechunk( void *arg ) {
+    graphfile_chunk_t *chunk = (graphfile_chunk_t *)arg;
+    const char *pos = chunk->begin;
+    long vals[GRAPHFILE_LINE_MAX];
+    int cnt;
+
+    chunk->lines = 0;
+    chunk->edges = 0;
+    chunk->errors = 0;
+    while( pos < chunk->end ) {
+        cnt = graphfile_scanline( &pos, chunk->end, vals, GRAPHFILE_LINE_MAX );
         if( cnt == 2 ) {
-            graph_setValue( graph, elems[0], elems[1], 1 );
-        } else if( cnt == 3 ) {
-            graph_setValue( graph, elems[0], elems[1], elems[2] );
+            vals[2] = 1;
+        }
+        if( cnt == 0 ) {
+            /* Empty line */
+        } else if( cnt != 2 && cnt != 3 ) {
+            graphfile_addError( chunk, "expected \"node node [weight]\"" );
+        } else if( vals[0] < 0 || vals[0] >= chunk->nodes ||
+                vals[1] < 0 || vals[1] >= chunk->nodes ) {
+            graphfile_addError( chunk, "node out of range" );
+        } else if( vals[0] == vals[1] ) {
+            graphfile_addError( chunk, "edge from a node to itself" );
         } else {
-            DBGPRINT( 0, "Unknown line" );
-            DBGSTR( 0, line );
+            graphfile_addEdge( chunk, vals[0], vals[1], vals[2] );
+        }
+        chunk->lines++;
+    }
+    return NULL;
+}
+
+/* Split the data from *pos into a batch of chunks ending at line ends.
+ * Returns the number of chunks.
+ */
+int graphfile_split( graphfile_chunk_t *chunk, const char **pos, const char *end ) {
+    int used;
+
+    for( used = 0; used < graphfile_threads && *pos < end; used++ ) {
+        chunk[used].begin = *pos;
+        *pos = end - *pos > GRAPHFILE_CHUNK ? *pos + GRAPHFILE_CHUNK : end;
+        while( *pos < end && (*pos)[-1] != '\n' ) {
+            (*pos)++;
+        }
+        chunk[used].end = *pos;
+    }
+    return used;
+}
+
+/* Report the errors and store the edges of a parsed batch, in file order
+ * so later lines for an edge win
+ */
+void graphfile_store( graph_t *graph, graphfile_chunk_t *chunk, int used, long *line ) {
+    long k;
+    int t;
+
+    for( t = 0; t < used; t++ ) {
+        for( k = 0; k < chunk[t].errors; k++ ) {
+            fprintf( stderr, "Line %ld: %s\n", *line + chunk[t].error[k].line, chunk[t].error[k].msg );
         }
+        for( k = 0; k < chunk[t].edges; k++ ) {
+            graph_setValue( graph, chunk[t].edge[k].n1, chunk[t].edge[k].n2, chunk[t].edge[k].val );
+        }
+        *line += chunk[t].lines;
+    }
+}
+
+/* Parse a whole file in memory. While the threads parse a batch of chunks,
+ * this thread stores the previous batch in the graph.
+ */
+graph_t *graphfile_parse( const char *data, size_t size ) {
+    graphfile_chunk_t chunk[2][GRAPHFILE_THREADS_MAX];
+    pthread_t thread[GRAPHFILE_THREADS_MAX];
+    int started[GRAPHFILE_THREADS_MAX];
+    const char *pos, *end = data + size;
+    long vals[GRAPHFILE_LINE_MAX];
+    long line;
+    int used[2];
+    int t, cur, cnt;
+    graph_t *graph;
+
+    /* Parse header */
+    pos = data;
+    cnt = graphfile_scanline( &pos, end, vals, GRAPHFILE_LINE_MAX );
+    if( cnt != 1 || vals[0] < 0 ) {
+        fprintf( stderr, "Line 1: expected the number of nodes\n" );
+        return NULL;
+    }
+    if( vals[0] > graphfile_maxnodes ) {
+        fprintf( stderr, "Line 1: more than %ld nodes\n", (long)graphfile_maxnodes );
+        return NULL;
+    }
+    graph = graph_create( vals[0] );
+
+    /* All edges are non-edges (-1) after graph_create, as needed for
+     * unweighted files. Not touching them keeps sparse graphs sparse.
+     */
+    for( cur = 0; cur < 2; cur++ ) {
+        for( t = 0; t < graphfile_threads; t++ ) {
+            chunk[cur][t].nodes = graph_getNodeCount( graph );
+            chunk[cur][t].edge = NULL;
+            chunk[cur][t].size = 0;
+            chunk[cur][t].error = NULL;
+            chunk[cur][t].errsize = 0;
+        }
+    }
+
+    line = 2;
+    cur = 0;
+    used[0] = graphfile_split( chunk[0], &pos, end );
+    used[1] = 0;
+    for(;;) {
+        for( t = 0; t < used[cur]; t++ ) {
+            started[t] = pthread_create( &thread[t], NULL, graphfile_parsechunk, &chunk[cur][t] ) == 0;
+            if( !started[t] ) {
+                graphfile_parsechunk( &chunk[cur][t] );
+            }
+        }
+        graphfile_store( graph, chunk[1-cur], used[1-cur], &line );
+        for( t = 0; t < used[cur]; t++ ) {
+            if( started[t] ) {
+                pthread_join( thread[t], NULL );
+            }
+        }
+        if( used[cur] == 0 ) {
+            break;
+        }
+        used[1-cur] = graphfile_split( chunk[1-cur], &pos, end );
+        cur = 1 - cur;
+    }
+
+    for( cur = 0; cur < 2; cur++ ) {
+        for( t = 0; t < graphfile_threads; t++ ) {
+            fmem_free( chunk[cur][t].edge );
+            fmem_free( chunk[cur][t].error );
+        }
+    }
+    return graph;
+}
+
+
+graph_t *graphfile_readfobj( FILE *fp ) {
+    char *data;
+    size_t len;
+    graph_t *graph;
+    int c;
+
+    /* PACE files are read as they arrive */
+    c = getc( fp );
+    if( c == EOF ) {
+        return NULL;
     }
+    ungetc( c, fp );
+    if( c == 'c' || c == 'p' ) {
+        return pacefile_readfobj( fp );
+    }
+
+    data = graphfile_slurp( fp, &len );
 
+    /* A binary graph keeps using the buffer */
+    if( graph_isBinary( data, len ) ) {
+        return graphfile_createMapped( data, len, graphfile_freebuffer );
+    }
+
+    graph = graphfile_parse( data, len );
+    fmem_free( data );
     return graph;
 }
 
+/* Streams can't be mapped, so read it all */
+char *graphfile_slurp( FILE *fp, size_t *len ) {
+    char *data, *tmp;
+    size_t size, got;
+
+    size = 1 << 16;
+    *len = 0;
+    data = fmem_alloc( size );
+    while( ( got = fread( data + *len, 1, size - *len, fp ) ) > 0 ) {
+        *len += got;
+        if( *len == size ) {
+            tmp = fmem_alloc( size * 2 );
+            memcpy( tmp, data, *len );
+            fmem_free( data );
+            data = tmp;
+            size *= 2;
+        }
+    }
+    return data;
+}
+
 
 graph_t *graphfile_readfile( const char *filename ) {
     FILE *fp;
     graph_t *graph;
+    struct stat st;
+    void *data;
+    int fd;
+
+    fd = open( filename, O_RDONLY );
+    if( fd < 0 ) {
+        return NULL;
+    }
+    if( fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) && st.st_size > 0 ) {
+        data = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        if( data != MAP_FAILED && graph_isBinary( data, st.st_size ) ) {
+            /* Map again writable, edits are copied on write */
+            munmap( data, st.st_size );
+            data = mmap( NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+            close( fd );
+            if( data == MAP_FAILED ) {
+                return NULL;
+            }
+            return graphfile_createMapped( data, st.st_size, graphfile_unmap );
+        }
+        if( data != MAP_FAILED ) {
+            close( fd );
+            if( pacefile_detect( (const char *)data, st.st_size ) ) {
+                graph = pacefile_readmem( (const char *)data, st.st_size );
+            } else {
+                graph = graphfile_parse( (const char *)data, st.st_size );
+            }
+            munmap( data, st.st_size );
+            return graph;
+        }
+    }
+    close( fd );
+
     fp = fopen( filename, "r" );
     if( fp == NULL ) {
         return NULL;
@@ -106,18 +431,180 @@ graph_t *graphfile_readfile( const char *filename ) {
 }
 
 
+/* Release callbacks of graph_createMapped, which has checked size against
+ * the header and sections before using the buffer. Only munmap needs the
+ * size back.
+ */
+void graphfile_unmap( void *data, size_t size ) {
+    munmap( data, size );
+}
+
+void graphfile_freebuffer( void *data, size_t size ) {
+    (void)size;
+    fmem_free( data );
+}
+
+
+/* Binary graph in data, released by unmap also when it can't be used */
+graph_t *graphfile_createMapped( void *data, size_t size, void (*unmap)( void *, size_t ) ) {
+    graph_t *graph;
+
+    graph = graph_createMapped( data, size, unmap );
+    if( graph == NULL ) {
+        fprintf( stderr, "Unsupported binary graph\n" );
+        if( unmap != NULL ) {
+            (*unmap)( data, size );
+        }
+    } else if( graph_getNodeCount( graph ) > graphfile_maxnodes ) {
+        fprintf( stderr, "More than %ld nodes\n", (long)graphfile_maxnodes );
+        graph_free( graph );
+        graph = NULL;
+    }
+    return graph;
+}
+
+graph_t *graphfile_readmem( char *data, size_t size ) {
+    if( graph_isBinary( data, size ) ) {
+        return graphfile_createMapped( data, size, NULL );
+    }
+    if( pacefile_detect( data, size ) ) {
+        return pacefile_readmem( data, size );
+    }
+    return graphfile_parse( data, size );
+}
+
+
+graphfile_stream_t *graphfile_openstream( const char *filename ) {
+    graphfile_stream_t *stream;
+    struct stat st;
+    FILE *fp;
+    int fd;
+
+    stream = fmem_alloc( sizeof( graphfile_stream_t ) );
+    stream->data = NULL;
+    stream->mapped = 0;
+
+    if( strcmp( filename, "-" ) != 0 ) {
+        fd = open( filename, O_RDONLY );
+        if( fd < 0 ) {
+            fmem_free( stream );
+            return NULL;
+        }
+        if( fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) && st.st_size > 0 ) {
+            stream->data = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+            if( stream->data != MAP_FAILED ) {
+                stream->size = st.st_size;
+                stream->mapped = 1;
+            } else {
+                stream->data = NULL;
+            }
+        }
+        close( fd );
+    }
+
+    if( stream->data == NULL ) {
+        fp = strcmp( filename, "-" ) == 0 ? stdin : fopen( filename, "r" );
+        if( fp == NULL ) {
+            fmem_free( stream );
+            return NULL;
+        }
+        stream->data = graphfile_slurp( fp, &stream->size );
+        if( fp != stdin ) {
+            fclose( fp );
+        }
+    }
+
+    stream->pos = stream->data;
+    return stream;
+}
+
+/* Start of the graph after the one at begin: the next line with a single
+ * number, a "p" line other than the first of a PACE graph, or a "c" line
+ * after a text graph
+ */
+const char *graphfile_nextgraph( const char *begin, const char *end, int pace ) {
+    const char *line, *pos;
+    long vals[GRAPHFILE_LINE_MAX];
+    int header = !pace;
+
+    for( line = begin; line < end; line = pos ) {
+        pos = line;
+        if( *line == 'p' ) {
+            if( header ) {
+                return line;
+            }
+            header = 1;
+        } else if( *line == 'c' ) {
+            if( !pace && line > begin ) {
+                return line;
+            }
+        } else if( graphfile_scanline( &pos, end, vals, GRAPHFILE_LINE_MAX ) == 1 && line > begin ) {
+            return line;
+        }
+        pos = memchr( line, '\n', end - line );
+        pos = pos != NULL ? pos + 1 : end;
+    }
+    return end;
+}
+
+graph_t *graphfile_readstream( graphfile_stream_t *stream ) {
+    const char *end = stream->data + stream->size;
+    const char *begin, *next;
+    long vals[GRAPHFILE_LINE_MAX];
+    graph_t *graph;
+    int pace;
+
+    while( stream->pos < end ) {
+        /* Skip blank lines between graphs */
+        begin = stream->pos;
+        if( graphfile_scanline( &stream->pos, end, vals, GRAPHFILE_LINE_MAX ) == 0 ) {
+            continue;
+        }
+
+        pace = pacefile_detect( begin, end - begin );
+        next = graphfile_nextgraph( begin, end, pace );
+        stream->pos = next;
+        if( pace ) {
+            graph = pacefile_readmem( begin, next - begin );
+        } else {
+            graph = graphfile_parse( begin, next - begin );
+        }
+        if( graph != NULL ) {
+            return graph;
+        }
+    }
+    return NULL;
+}
+
+void graphfile_closestream( graphfile_stream_t *stream ) {
+    if( stream->mapped ) {
+        munmap( stream->data, stream->size );
+    } else {
+        fmem_free( stream->data );
+    }
+    fmem_free( stream );
+}
 
 
 int graphfile_writefobj( const graph_t *graph, FILE *fp ) {
-    int i, j, nodecnt;
+    graph_index_t i, j, nodecnt;
+    outbuf_t *ob;
+
+    ob = outbuf_create( fp );
     nodecnt = graph_getNodeCount( graph );
-    fprintf( fp, "%d\n", nodecnt );
+    outbuf_putlong( ob, nodecnt, 0 );
+    outbuf_putc( ob, '\n' );
     for( i=0; i<nodecnt; i++ ) {
         for( j=i+1; j<nodecnt; j++ ) {
-            fprintf( fp, "%d %d %ld\n", i, j, graph_getValue( graph, i, j ) );
+            outbuf_putlong( ob, i, 0 );
+            outbuf_putc( ob, ' ' );
+            outbuf_putlong( ob, j, 0 );
+            outbuf_putc( ob, ' ' );
+            outbuf_putlong( ob, graph_getValue( graph, i, j ), 0 );
+            outbuf_putc( ob, '\n' );
         }
     }
-    return 1;
+    return outbuf_free( ob );
 }
 
 int graphfile_writefile( const graph_t *graph, const char *filename ) {
@@ -133,3 +620,19 @@ int graphfile_writefile( const graph_t *graph, const char *filename ) {
     fclose( fp );
     return retval;
 }
+
+int graphfile_writebinary( const graph_t *graph, const char *filename ) {
+    int retval;
+    FILE *fp;
+    fp = fopen( filename, "wb" );
+    if( fp == NULL ) {
+        return 0;
+    }
+
+    retval = graph_writeBinary( graph, fp );
+
+    if( fclose( fp ) != 0 ) {
+        retval = 0;
+    }
+    return retval;
+}
@@ -21,10 +21,52 @@
 #include <stdio.h>
 #include "graph.h"
 
+/* Number of threads parsing a file */
+void graphfile_setThreads( int threads );
+
+/* Largest node count accepted in any format, GRAPH_NODES_MAX initially.
+ * Graphs with more nodes are refused before their storage is allocated.
+ */
+void graphfile_setMaxNodes( graph_size_t nodes );
+graph_size_t graphfile_getMaxNodes( void );
+
+/* Read a graph, "nodes" on the first line and then "node node [weight]"
+ * per line. Files are mapped, streams are read whole. Bad lines are
+ * reported with their line number on stderr, and skipped. Returns NULL if
+ * the file can't be read or has no node count.
+ * Binary graphs, see graph_writeBinary, are recognized and used in place,
+ * in their own layout and width. PACE files are recognized by their "c" or
+ * "p" lines, see pacefile.h.
+ */
 graph_t *graphfile_readfobj( FILE *fp );
 graph_t *graphfile_readfile( const char *filename );
 
+/* Read a graph in any of the formats from memory. A binary graph uses data
+ * in place, so data must be writable and outlive the graph.
+ */
+graph_t *graphfile_readmem( char *data, size_t size );
+
+/* Files of concatenated graphs, in the text or PACE format. A line with a
+ * single number starts a text graph, and a "c" or "p" line after a text
+ * graph, or a second "p" line, a PACE graph. Line numbers in errors count
+ * from the start of each graph.
+ */
+typedef struct graphfile_stream_t graphfile_stream_t;
+
+/* Open filename, or standard input for "-". Returns NULL if it can't be
+ * read.
+ */
+graphfile_stream_t *graphfile_openstream( const char *filename );
+
+/* Next graph, or NULL at the end. Graphs that can't be read are skipped. */
+graph_t *graphfile_readstream( graphfile_stream_t *stream );
+
+void graphfile_closestream( graphfile_stream_t *stream );
+
 int graphfile_writefobj( const graph_t *graph, FILE *fp );
 int graphfile_writefile( const graph_t *graph, const char *filename );
 
+/* Write graph as a binary graph, returns 0 on failure */
+int graphfile_writebinary( const graph_t *graph, const char *filename );
+
 #endif
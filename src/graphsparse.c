@@ -0,0 +1,107 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+
+#include "debug.h"
+#include "graph.h"
+#include "graphsparse.h"
+#include "fmem.h"
+
+#define GRAPHSPARSE_MIN_CAPACITY 4
+
+/* Multiplicative hashing, spreads consecutive nodes over the table */
+#define GRAPHSPARSE_HASH( _N, _MASK ) ( ( (unsigned long)(_N) * 2654435761UL ) & (unsigned long)(_MASK) )
+
+static void graphsparse_alloc( graphsparse_row_t *row, graph_size_t capacity );
+static void graphsparse_grow( graphsparse_row_t *row );
+
+static void graphsparse_alloc( graphsparse_row_t *row, graph_size_t capacity ) {
+    graph_size_t i;
+
+    row->key = fmem_alloc_arr( sizeof( graph_index_t ), capacity );
+    row->value = fmem_alloc_arr( sizeof( graph_value_t ), capacity );
+    row->used = 0;
+    row->mask = capacity - 1;
+    for( i = 0; i < capacity; i++ ) {
+        row->key[i] = -1;
+    }
+}
+
+/* Double the capacity and rehash all entries */
+static void graphsparse_grow( graphsparse_row_t *row ) {
+    graphsparse_row_t old;
+    graph_size_t i;
+
+    old = *row;
+    graphsparse_alloc( row, ( old.mask + 1 ) * 2 );
+    for( i = 0; i <= old.mask; i++ ) {
+        if( old.key[i] >= 0 ) {
+            graphsparse_set( row, old.key[i], old.value[i] );
+        }
+    }
+    fmem_free( old.key );
+    fmem_free( old.value );
+}
+
+void graphsparse_init( graphsparse_row_t *row ) {
+    graphsparse_alloc( row, GRAPHSPARSE_MIN_CAPACITY );
+}
+
+void graphsparse_free( graphsparse_row_t *row ) {
+    fmem_free( row->key );
+    fmem_free( row->value );
+}
+
+void graphsparse_clear( graphsparse_row_t *row ) {
+    graphsparse_free( row );
+    graphsparse_init( row );
+}
+
+int graphsparse_get( const graphsparse_row_t *row, graph_index_t n, graph_value_t *val ) {
+    graph_size_t i;
+
+    for( i = GRAPHSPARSE_HASH( n, row->mask ); row->key[i] >= 0; i = ( i + 1 ) & row->mask ) {
+        if( row->key[i] == n ) {
+            *val = row->value[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void graphsparse_set( graphsparse_row_t *row, graph_index_t n, graph_value_t val ) {
+    graph_size_t i;
+
+    ASSERT( n >= 0 );
+    for( i = GRAPHSPARSE_HASH( n, row->mask ); row->key[i] >= 0; i = ( i + 1 ) & row->mask ) {
+        if( row->key[i] == n ) {
+            row->value[i] = val;
+            return;
+        }
+    }
+
+    /* Keep at least half of the table empty, so probes stay short */
+    if( ( row->used + 1 ) * 2 > row->mask + 1 ) {
+        graphsparse_grow( row );
+        graphsparse_set( row, n, val );
+        return;
+    }
+    row->key[i] = n;
+    row->value[i] = val;
+    row->used++;
+}
@@ -0,0 +1,45 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef GRAPHSPARSE_H
+#define GRAPHSPARSE_H
+
+#include "graph.h"
+
+/* Row of a sparse graph: the explicitly stored edge values of one node,
+ * in an open addressing hash table keyed by the other node.
+ * Entries are never removed, only updated.
+ */
+struct graphsparse_row_t {
+    graph_index_t   *key;   /* Other node, or -1 if unused */
+    graph_value_t   *value;
+    graph_size_t    used;
+    graph_size_t    mask;   /* Capacity - 1, capacity is a power of two */
+};
+
+void graphsparse_init( graphsparse_row_t *row );
+void graphsparse_free( graphsparse_row_t *row );
+
+/* Remove all entries */
+void graphsparse_clear( graphsparse_row_t *row );
+
+/* Returns 1 and sets *val if n is stored in row, otherwise returns 0 */
+int graphsparse_get( const graphsparse_row_t *row, graph_index_t n, graph_value_t *val );
+
+void graphsparse_set( graphsparse_row_t *row, graph_index_t n, graph_value_t val );
+
+#endif
@@ -23,6 +23,12 @@
 #include "graphstate.h"
 #include "fmem.h"
 
+/* Paths to fetch up to this length need no allocation */
+#define GRAPHSTATE_FETCH_LOCAL 64
+
+void graphstate_step( graphstate_t *graphstate, const graph_model_t *model );
+graph_index_t graphstate_find( graph_index_t *parent, graph_index_t n );
+
 graphstate_t *graphstate_create_base( graph_t *graph, graph_cost_t cost_left ) {
     graphstate_t *graphstate = fmem_alloc( sizeof( graphstate_t ) );
 
@@ -96,48 +102,79 @@ void graphstate_garbage_collect( graphstate_t *graphstate ) {
     }
 }
 
-void graphstate_fetch( graphstate_t *graphstate, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
+/* Apply the changeset of graphstate to its target, which must be an org,
+ * and turn the link around so graphstate becomes the org
+ */
+void graphstate_step( graphstate_t *graphstate, const graph_model_t *model ) {
     graphstate_t        *target;
     graphstate_chset_t  *chset;
     graphstate_org_t    *org;
     graph_cost_t        cost;
-    if( graphstate->type == GRAPHSTATE_TYPE_CHANGESET ) {
-        target = graphstate->c.chset->target;
 
-        graphstate_fetch( target, fixpoint, bookkeepingValue ); /* TODO: Make non-recursive */
+    target = graphstate->c.chset->target;
+    ASSERT( target->type == GRAPHSTATE_TYPE_ORG );
 
-        /* target will point to graphstate */
-        graphstate_incref( graphstate );
+    /* target will point to graphstate */
+    graphstate_incref( graphstate );
 
-        org = target->c.org;
-        chset = graphstate->c.chset;
+    org = target->c.org;
+    chset = graphstate->c.chset;
 
-        cost = graph_apply( org->graph, chset->chset, fixpoint, bookkeepingValue );
+    cost = graph_apply( org->graph, chset->chset, model );
 
-        target->type = GRAPHSTATE_TYPE_CHANGESET;
-        target->c.chset = chset;
-        target->c.chset->target = graphstate;
+    target->type = GRAPHSTATE_TYPE_CHANGESET;
+    target->c.chset = chset;
+    target->c.chset->target = graphstate;
 
-        graphstate->type = GRAPHSTATE_TYPE_ORG;
-        graphstate->c.org = org;
+    graphstate->type = GRAPHSTATE_TYPE_ORG;
+    graphstate->c.org = org;
+
+    /* Update next cost, if not updated before.
+     * (This test makes it unnessecary to calculate reverse cost when
+     * reversing edits, like splitting merged nodes
+     */
+    if( graphstate->cost < 0 ) {
+        graphstate->cost      = target->cost + cost;
+        graphstate->cost_left = target->cost_left - cost;
+    }
 
-        /* Update next cost, if not updated before.
-         * (This test makes it unnessecary to calculate reverse cost when
-         * reversing edits, like splitting merged nodes
-         */
-        if( graphstate->cost < 0 ) {
-            graphstate->cost      = target->cost + cost;
-            graphstate->cost_left = target->cost_left - cost;
-        }
+    /* graphstate doesn't point to target anymore */
+    graphstate_decref( target );
+}
+
+void graphstate_fetch( graphstate_t *graphstate, const graph_model_t *model ) {
+    graphstate_t        *local[GRAPHSTATE_FETCH_LOCAL];
+    graphstate_t        **path;
+    graphstate_t        *cur;
+    long                depth, i;
+
+    /* Collect the path to the org, and apply it from the org end, without
+     * recursing once per changeset
+     */
+    depth = 0;
+    for( cur = graphstate; cur->type == GRAPHSTATE_TYPE_CHANGESET; cur = cur->c.chset->target ) {
+        depth++;
+    }
+    if( depth == 0 ) {
+        return;
+    }
 
-        /* graphstate doesn't point to target anymore */
-        graphstate_decref( target );
+    path = depth > GRAPHSTATE_FETCH_LOCAL ? fmem_alloc_arr( sizeof( graphstate_t * ), depth ) : local;
+    i = depth;
+    for( cur = graphstate; cur->type == GRAPHSTATE_TYPE_CHANGESET; cur = cur->c.chset->target ) {
+        path[--i] = cur;
+    }
+    for( i = 0; i < depth; i++ ) {
+        graphstate_step( path[i], model );
+    }
+    if( path != local ) {
+        fmem_free( path );
     }
 }
 
-void graphstate_lock( graphstate_t *graphstate, graph_cost_t fixpoint, graph_cost_t bookkeepingValue ) {
+void graphstate_lock( graphstate_t *graphstate, const graph_model_t *model ) {
     /* TODO: make threadsafe */
-    graphstate_fetch( graphstate, fixpoint, bookkeepingValue );
+    graphstate_fetch( graphstate, model );
 }
 
 void graphstate_unlock( graphstate_t *graphstate ) {
@@ -153,21 +190,55 @@ void graphstate_decref( graphstate_t *graphstate ) {
 }
 
 
+graph_index_t graphstate_find( graph_index_t *parent, graph_index_t n ) {
+    while( parent[n] != n ) {
+        parent[n] = parent[parent[n]]; /* Path halving */
+        n = parent[n];
+    }
+    return n;
+}
+
 void graphstate_tracemerges( graphstate_t *basestate, graph_index_t *idlist ) {
+    graphstate_t *cur;
     graph_chSet_t *chset;
+    graph_index_t *parent, *label;
+    graph_index_t i, a, b;
+    graph_size_t nodes;
+
+    for( cur = basestate; cur->type == GRAPHSTATE_TYPE_CHANGESET; cur = cur->c.chset->target );
+    nodes = graph_getNodeCount( cur->c.org->graph );
+
+    parent = fmem_alloc_arr( sizeof( graph_index_t ), nodes + 1 );
+    label  = fmem_alloc_arr( sizeof( graph_index_t ), nodes + 1 );
+    for( i = 0; i < nodes; i++ ) {
+        parent[i] = i;
+        label[i] = -1;
+    }
 
-    /* FIXME: make nonrecurive */
-    if( basestate->type == GRAPHSTATE_TYPE_CHANGESET ) {
-        DBGPRINT( 22, "Tracing" );
-        graphstate_tracemerges( basestate->c.chset->target, idlist );
-
-        chset = basestate->c.chset->chset;
-
-        /* If merge, propagate id to child node */
-        if( chset->func == graph_apply_split ) { /* FIXME: Do not compare pointers!!! */
-            idlist[chset->n2] = idlist[chset->n1];
+    /* The path back to basestate splits every merge done since, so join
+     * the nodes of each split. The order of the merges doesn't matter.
+     */
+    for( cur = basestate; cur->type == GRAPHSTATE_TYPE_CHANGESET; cur = cur->c.chset->target ) {
+        chset = cur->c.chset->chset;
+        if( chset->op == GRAPH_OP_SPLIT ) {
             DBGLONG( 22, chset->n1 );
             DBGLONG( 22, chset->n2 );
+            a = graphstate_find( parent, chset->n1 );
+            b = graphstate_find( parent, chset->n2 );
+            parent[b] = a;
         }
     }
+
+    /* Every set has one node still active, which already has an id */
+    for( i = 0; i < nodes; i++ ) {
+        if( idlist[i] >= 0 ) {
+            label[ graphstate_find( parent, i ) ] = idlist[i];
+        }
+    }
+    for( i = 0; i < nodes; i++ ) {
+        idlist[i] = label[ graphstate_find( parent, i ) ];
+    }
+
+    fmem_free( parent );
+    fmem_free( label );
 }
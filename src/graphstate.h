@@ -61,10 +61,13 @@ void graphstate_reverse( graphstate_t *graphstate );
  * Between lock and unlock graphstate is always type org.
  * TODO: Make thread safe
  */
-void graphstate_lock( graphstate_t *graphstate, graph_cost_t fixpoint, graph_cost_t bookkeepingValue );
+void graphstate_lock( graphstate_t *graphstate, const graph_model_t *model );
 void graphstate_unlock( graphstate_t *graphstate );
 
-void graphstate_fetch( graphstate_t *graphstate, graph_cost_t fixpoint, graph_cost_t bookkeepingValue );
+/* Make graphstate the org, applying the changesets on the way from the
+ * current org iteratively
+ */
+void graphstate_fetch( graphstate_t *graphstate, const graph_model_t *model );
 
 /* Increment and decrement reference counters.
  * When creating a reference, use incref.
@@ -75,6 +78,10 @@ void graphstate_fetch( graphstate_t *graphstate, graph_cost_t fixpoint, graph_co
 void graphstate_incref( graphstate_t *graphstate );
 void graphstate_decref( graphstate_t *graphstate );
 
+/* Give every node merged on the way from basestate to the current org the
+ * id in idlist of the active node it was merged into. Near linear in the
+ * number of nodes and changesets.
+ */
 void graphstate_tracemerges( graphstate_t *basestate, graph_index_t *idlist );
 
 #endif
@@ -41,13 +41,14 @@ void getMax(kernel_heap_t *heaps, graph_value_t *maxIcp, graph_value_t *maxIcf,
 void printheaps(kernel_heap_t *heaps, graph_index_t nodes);
 #endif
 
-graphstate_t *kernel_kernelize(graphstate_t *gs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue) {
+graphstate_t *kernel_kernelize(graphstate_t *gs, const graph_model_t *model) {
     
     graph_t *graph;
     graphstate_t *newgs;
     graph_cost_t kparam = 0;
     graph_index_t i = 0, j = 0, k, node1, node2, node3;
     graph_index_t *lookup;
+    graph_value_t *row1, *row2, *row3; /* Rows of the graph, indexed by node */
     graph_value_t cost1,cost2, cost3, maxIcp = 0, maxIcf = 0;
     graph_size_t nodes = 0;
     kernel_heap_t bestIcp, bestIcf;
@@ -55,7 +56,7 @@ graphstate_t *kernel_kernelize(graphstate_t *gs, graph_cost_t fixpoint, graph_co
     kernel_heapnode_t *heapnode, *heapnode1, *heapnode2;
 
    
-    graphstate_lock( gs, fixpoint, bookkeepingValue );
+    graphstate_lock( gs, model );
     graph = gs->c.org->graph;
     ASSERT( graph );
 
@@ -67,14 +68,18 @@ graphstate_t *kernel_kernelize(graphstate_t *gs, graph_cost_t fixpoint, graph_co
     
     lookup = malloc(sizeof(graph_index_t)*nodes);
     heaps = malloc(sizeof(kernel_heap_t)*nodes*2);
+    row1 = malloc(sizeof(graph_value_t)*graph_getNodeCount(graph));
+    row2 = malloc(sizeof(graph_value_t)*graph_getNodeCount(graph));
+    row3 = malloc(sizeof(graph_value_t)*graph_getNodeCount(graph));
     
     i = 0;
     while(i >= 0) {
         lookup[j++] = i;
         i = graph_getNext(graph, i);
     }
-    heaps[nodes-2].node = nodes - 1;
-    heaps[nodes-1].node = nodes - 1;
+    /* The last node has no heaps, but is marked as not merged away */
+    heaps[nodes*2-2].node = nodes - 1;
+    heaps[nodes*2-1].node = nodes - 1;
     /* Calculate and initialize all icp and icf values on the heaps */
     for (i = 0; i < nodes*2-2; i += 2) {
         node1 = i/2;
@@ -86,8 +91,10 @@ graphstate_t *kernel_kernelize(graphstate_t *gs, graph_cost_t fixpoint, graph_co
         heaps[i+1].size = 0;
         heaps[i+1].heap = malloc(sizeof(kernel_heapnode_t)*(nodes-node1-1));
         heaps[i+1].mapping = malloc(sizeof(graph_index_t)*(nodes-node1-1));
+        graph_getRow(graph, lookup[node1], row1);
         for (j = 0; j < nodes-node1-1; j++) {
             node2 = node1+j+1;
+            graph_getRow(graph, lookup[node2], row2);
             heaps[i].mapping[j] = j;
             heaps[i+1].mapping[j] = j;
             heaps[i].heap[j].cost = 0;
@@ -100,8 +107,8 @@ graphstate_t *kernel_kernelize(graphstate_t *gs, graph_cost_t fixpoint, graph_co
                 if (k == node1 || k == node2) {
                     continue;
                 }
-                cost1 = graph_getValue(graph, lookup[node1], lookup[k]);
-                cost2 = graph_getValue(graph, lookup[node2], lookup[k]);
+                cost1 = row1[lookup[k]];
+                cost2 = row2[lookup[k]];
                 if (cost1 > 0 && cost2 > 0) {
                     heaps[i].heap[j].cost += (cost1 < cost2 ? cost1:cost2);
                 }
@@ -109,8 +116,8 @@ graphstate_t *kernel_kernelize(graphstate_t *gs, graph_cost_t fixpoint, graph_co
                     heaps[i+1].heap[j].cost += (abs(cost1) < abs(cost2) ? abs(cost1):abs(cost2));
                 }
             }
-            cost1 = graph_getValue(graph, lookup[node1], lookup[node2]);
-            if (abs(cost1) > 50000L){
+            cost1 = row1[lookup[node2]];
+            if (GRAPH_ISFORBIDDEN(cost1) || GRAPH_ISPERSISTANT(cost1)) {
                 heaps[i].heap[j].cost = 0;
                 heaps[i+1].heap[j].cost = 0;
             }
@@ -141,7 +148,7 @@ graphstate_t *kernel_kernelize(graphstate_t *gs, graph_cost_t fixpoint, graph_co
 
     /* Phase 2, find the maximum induced costs and merge or setForbidden accordingly */
     while ( 1 ) {
-        graphstate_lock( gs, fixpoint, bookkeepingValue );
+        graphstate_lock( gs, model );
         graph = gs->c.org->graph;
         kparam = gs->cost_left; /* TODO: Use access method */
 
@@ -149,17 +156,17 @@ graphstate_t *kernel_kernelize(graphstate_t *gs, graph_cost_t fixpoint, graph_co
         DBGLONG( 11, maxIcp );
         DBGLONG( 11, maxIcf );
 
-        if( (maxIcp*fixpoint <= kparam && maxIcf*fixpoint <= kparam) || kparam < 1 ) {
+        if( (maxIcp*model->fixpoint <= kparam && maxIcf*model->fixpoint <= kparam) || kparam < 1 ) {
             graphstate_unlock( gs );
             break;
         }
 
         /* Forbid edge... */
-        if (maxIcp*fixpoint > kparam) {
+        if (maxIcp*model->fixpoint > kparam) {
             node1 = bestIcp.node;
             node2 = bestIcp.heap[0].node;
             cost1 = graph_getValue(graph, lookup[node1], lookup[node2]);
-            if (cost1 < -50000L) {
+            if (GRAPH_ISFORBIDDEN(cost1)) {
                 bestIcp.heap[0].cost = 0;
                 findheapnode(heaps, node1, node2, 0)->cost = 0;
                 restoreProp(heaps, node1, node2, 0);
@@ -228,11 +235,13 @@ graphstate_t *kernel_kernelize(graphstate_t *gs, graph_cost_t fixpoint, graph_co
         }
 
         /* Merge edge */
-        else if (maxIcf*fixpoint > kparam) {
+        else if (maxIcf*model->fixpoint > kparam) {
             node1 = bestIcf.node;
             node2 = bestIcf.heap[0].node;
             heaps[node2*2].node = -1;
             heaps[node2*2 + 1].node = -1;
+            graph_getRow(graph, lookup[node1], row1);
+            graph_getRow(graph, lookup[node2], row2);
             for(i = 0; i < nodes; i ++) {
                 if (heaps[2*i].node < 0 || i == node2 || i == node1) {
                     continue;
@@ -248,14 +257,14 @@ graphstate_t *kernel_kernelize(graphstate_t *gs, graph_cost_t fixpoint, graph_co
                 heapnode2 = findheapnode(heaps, node1, i, 1);
                 heapnode1->cost = 0;
                 heapnode2->cost = 0;
+                graph_getRow(graph, lookup[i], row3);
                 for (j = 0; j < nodes; j++) {
                     if (heaps[2*j].node < 0 || j == node1 || j == node2 || j == i) {
                         continue;
                     }
                     
-                    cost1 = graph_getValue(graph, lookup[node1], lookup[j]) + 
-                        graph_getValue(graph, lookup[node2], lookup[j]);
-                    cost2 = graph_getValue(graph, lookup[i], lookup[j]);
+                    cost1 = row1[lookup[j]] + row2[lookup[j]];
+                    cost2 = row3[lookup[j]];
                     if (cost1 > 0 && cost2 > 0) {
                         heapnode1->cost += (cost1 < cost2 ? cost1:cost2);
                     }
@@ -263,9 +272,8 @@ graphstate_t *kernel_kernelize(graphstate_t *gs, graph_cost_t fixpoint, graph_co
                         heapnode2->cost += (abs(cost1) < abs(cost2) ? abs(cost1):abs(cost2));
                     }
                 }
-                cost1 = graph_getValue(graph, lookup[node1], lookup[i]) + 
-                    graph_getValue(graph, lookup[node2], lookup[i]);
-                if (abs(cost1) > 50000L) {
+                cost1 = row1[lookup[i]] + row2[lookup[i]];
+                if (GRAPH_ISFORBIDDEN(cost1) || GRAPH_ISPERSISTANT(cost1)) {
                     findheapnode(heaps, node1, i, 0)->cost = 0;
                     findheapnode(heaps, node1, i, 1)->cost = 0;
                 }
@@ -313,6 +321,9 @@ graphstate_t *kernel_kernelize(graphstate_t *gs, graph_cost_t fixpoint, graph_co
     }
     free(lookup);
     free(heaps);
+    free(row1);
+    free(row2);
+    free(row3);
 
    return gs;
 }
@@ -20,5 +20,5 @@
 
 #include "graphstate.h"
 
-graphstate_t *kernel_kernelize(graphstate_t *gs, graph_cost_t fixpoint, graph_cost_t bookkeepingValue);
+graphstate_t *kernel_kernelize(graphstate_t *gs, const graph_model_t *model);
 #endif
@@ -24,17 +24,24 @@
 
 #include "debug.h"
 #include "graph.h"
-#include "graphstate.h"
 #include "sched.h"
 #include "strategy_depth_first.h"
 #include "alg_3k.h"
 #include "alg_2k.h"
 #include "alg_2_62k.h"
-#include "postprocess.h"
+#include "solve.h"
+#include "batch.h"
+#include "server.h"
+#include "bitgraph.h"
+#include "branch.h"
+#include "validate.h"
+#include "graphfile.h"
+#include "visual.h"
 #include "fmem.h"
 
 #include "datasource_random.h"
 #include "datasource_file.h"
+#include "datasource_batch.h"
 
 #ifdef OPENCV_COIN
 #include "datasource_cv_coin.h"
@@ -65,13 +72,37 @@ void usage( char *cmd ) {
             "    -d <num>      : Set debug level\n"
 #endif
             "    -s <num>      : Seed random number generator\n"
-            "    -a <algorithm>: Select algorithm\n"
+            "    -a <algorithm>: Select algorithm, 2k, 2.62k or 3k. Graphs of at most %d\n"
+            "                    nodes are solved by the bitset solver instead, unless\n"
+            "                    -x is given; costs are in the units of the algorithm\n"
+            "    -x            : Use the selected algorithm for all graphs\n"
+            , cmd, BITGRAPH_MAX_NODES);
+
+    fprintf( stderr,
+            "    -b <policy>   : Select conflict triple to branch on, for 3k and 2.62k\n"
+            "                    first, maxweight, maxconflict or branchnum\n"
+            "    -l <layout>   : Edge storage, triangular, square or sparse. Sparse\n"
+            "                    graphs are solved up to %d nodes\n"
+            "    -w <bytes>    : Initial bytes per edge value, 1, 2, 4 or 8\n"
+            "    -j <threads>  : Threads for loading files, validating solutions and\n"
+            "                    solving batches or requests\n", SOLVE_SPARSE_NODES_MAX );
+
+    fprintf( stderr,
+            "    -o            : Relabel nodes along positive edges before solving\n"
+            "    -W <filename> : Write the input as a binary graph, instead of solving\n"
+            "    -O <format>   : Solution output, text, csv (cluster by node), edits\n"
+            "                    (csv of edited pairs) or json. All but csv check\n"
+            "                    every pair of nodes for edits, in O(N^2)\n"
+            "    -v            : Print statistics to stderr\n"
             "    -h            : Show this help message\n"
-            "\n", cmd);
+            "\n");
 
     fprintf( stderr,
             "  Loading files:\n"
-            "    -f <filename> : Read cluster file\n"
+            "    -f <filename> : Read cluster file, text, PACE or binary\n"
+            "    -m <source>   : Solve many instances, from a directory, the files\n"
+            "                    matching a pattern or a file of concatenated graphs\n"
+            "    -S <socket>   : Stay resident, solving graphs sent to a Unix socket\n"
             "    -r <num of nodes>:<num of cliques>:<noise>:<max weight>\n"
             "                  : Generate random graph\n"
 #ifdef OPENCV_COIN
@@ -88,10 +119,8 @@ void usage( char *cmd ) {
 
 int main( int argc, char *argv[] ) {
     graph_t *graph;
-    graphstate_t *initstate;
-    graphstate_t *beststate;
-
     graph_index_t *cliqueid;
+    graph_cost_t cost;
     sched_t *sched;
     time_t seed;
     char *alg_name = NULL;
@@ -99,12 +128,16 @@ int main( int argc, char *argv[] ) {
 
     const datasource_t *datasource = NULL;
     datasource_storage_t *ds_store;
-
-#if DEBUG
-    long iterationcount;
-#endif
+    solve_t settings;
+    char *server_path = NULL;
 
     char *ds_args = NULL;
+    char *binary_name = NULL;
+
+    int use_bitgraph = 1;
+    int branching = BRANCH_FIRST;
+    int statistics = 0;
+    int reorder = 0;
 
     int opt,i;
 
@@ -116,7 +149,7 @@ int main( int argc, char *argv[] ) {
 #if DEBUG
                     "d:"
 #endif
-                    "s:a:hf:r:c:n:" ) ) != -1 ) {
+                    "s:a:xb:l:w:j:oW:O:vhf:m:S:r:c:n:" ) ) != -1 ) {
         switch( opt ) {
 #if DEBUG
             case 'd':
@@ -125,11 +158,64 @@ int main( int argc, char *argv[] ) {
 #endif
             case 's': seed = atoi( optarg ); break;
             case 'a': alg_name = optarg; break;
+            case 'x': use_bitgraph = 0; break;
+            case 'b':
+                      branching = branch_parse( optarg );
+                      if( branching < 0 ) usage( argv[0] );
+                      break;
+            case 'l':
+                      if( strcmp( optarg, "triangular" ) == 0 ) {
+                          graph_setDefaultLayout( GRAPH_LAYOUT_TRIANGULAR );
+                      } else if( strcmp( optarg, "square" ) == 0 ) {
+                          graph_setDefaultLayout( GRAPH_LAYOUT_SQUARE );
+                      } else if( strcmp( optarg, "sparse" ) == 0 ) {
+                          graph_setDefaultLayout( GRAPH_LAYOUT_SPARSE );
+                      } else {
+                          usage( argv[0] );
+                      }
+                      break;
+            case 'w':
+                      i = atoi( optarg );
+                      if( i != 1 && i != 2 && i != 4 && i != GRAPH_WIDTH_MAX ) {
+                          usage( argv[0] );
+                      }
+                      graph_setDefaultWidth( i );
+                      break;
+            case 'j':
+                      i = atoi( optarg );
+                      if( i < 1 ) usage( argv[0] );
+                      graphfile_setThreads( i );
+                      validate_setThreads( i );
+                      batch_setThreads( i );
+                      server_setThreads( i );
+                      break;
+            case 'o': reorder = 1; break;
+            case 'W': binary_name = optarg; break;
+            case 'O':
+                      if( strcmp( optarg, "text" ) == 0 ) {
+                          visual_setFormat( VISUAL_FORMAT_TEXT );
+                      } else if( strcmp( optarg, "csv" ) == 0 ) {
+                          visual_setFormat( VISUAL_FORMAT_CSV );
+                      } else if( strcmp( optarg, "edits" ) == 0 ) {
+                          visual_setFormat( VISUAL_FORMAT_EDITS );
+                      } else if( strcmp( optarg, "json" ) == 0 ) {
+                          visual_setFormat( VISUAL_FORMAT_JSON );
+                      } else {
+                          usage( argv[0] );
+                      }
+                      break;
+            case 'v': statistics = 1; break;
             case 'f':
                       if( datasource != NULL ) usage( argv[0] );
                       datasource = &datasource_file;
                       ds_args = optarg;
                       break;
+            case 'S': server_path = optarg; break;
+            case 'm':
+                      if( datasource != NULL ) usage( argv[0] );
+                      datasource = &datasource_batch;
+                      ds_args = optarg;
+                      break;
             case 'r':
                       if( datasource != NULL ) usage( argv[0] );
                       datasource = &datasource_random;
@@ -153,7 +239,8 @@ int main( int argc, char *argv[] ) {
         }
     }
 
-    if( datasource == NULL ) {
+    if( ( datasource == NULL ) == ( server_path == NULL ) ||
+            ( datasource == &datasource_batch && binary_name != NULL ) ) {
         usage( argv[0] );
     }
 
@@ -184,10 +271,28 @@ int main( int argc, char *argv[] ) {
     DBGLONG( 2, seed );
     srand( seed );
 
+    settings.strategy = &strategy_depthFirst;
+    settings.algorithm = alg;
+    settings.branching = branching;
+    settings.use_bitgraph = use_bitgraph;
+    settings.reorder = reorder;
+
+    /* Resident, solving the graphs sent to the socket */
+    if( server_path != NULL ) {
+        return server_run( server_path, &settings ) ? 0 : 1;
+    }
+
     ds_store = datasource_create( datasource, ds_args );
 
+    /* Many instances are solved in parallel */
+    if( datasource == &datasource_batch ) {
+        batch_run( ds_store, &settings );
+        datasource_free( ds_store );
+        return 0;
+    }
+
     /* Create sheduler (reuse every frame) */
-    sched = sched_create( &strategy_depthFirst, alg );
+    sched = solve_createSched( &settings );
 
     /* Start loop, (runs once for datasource random and file,
      * continuous for cv/camera
@@ -195,65 +300,41 @@ int main( int argc, char *argv[] ) {
     while( ( graph = datasource_get( ds_store ) ) != NULL ) {
         DBGPRINT( 9, "New frame" );
 
-        /* First reference is treated as local reference */
         ASSERT( graph );
-        if( graph_getNodeCount( graph ) > 0 ) {
-            initstate = graphstate_create_base( graph, 0 );
 
-#if DEBUG
-            iterationcount = 0;
-#endif
-            for(;;) {
-                DBGPRINT( 10, "-------------- Incrementing k-limit" );
-                /* Create a reference for job queue */
-                graphstate_incref( initstate );
-                sched_job_add( sched, initstate );
-                DBGLONG( 10, initstate->cost_left );
-                while( sched_stepone( sched ) ) {
-                    DBGPRINT( 15, "step done" );
-#if DEBUG
-                    iterationcount++;
-#endif
-                }
-                DBGLONG( 10, iterationcount );
-
-                beststate = sched_getBest( sched );
-                if( beststate == NULL ) {
-                    graphstate_lock( initstate, 0, 0 ); /* basecase: already got a cost */
-                    sched_inc_limit_job( sched, initstate );
-                    graphstate_unlock( initstate );
-                } else {
-                    /* We found something */
-                    break;
-                }
+        if( binary_name != NULL ) {
+            if( !graphfile_writebinary( graph, binary_name ) ) {
+                fprintf( stderr, "Can't write binary graph: %s\n", binary_name );
             }
-            DBGLONG( 5, iterationcount );
-
-            beststate = sched_resetBest( sched );
-
-            DBGINT( 5, beststate->type );
-            /* print best state */
-            /* node already visited through algorithm: already got a cost */
-            graphstate_lock( beststate, 0, 0 );
+            graph_free( graph );
+            break;
+        }
 
+        cliqueid = fmem_alloc_arr( sizeof( graph_index_t ), graph_getNodeCount( graph ) + 1 );
+        cost = solve_graph( sched, &settings, graph, 0, cliqueid );
+        if( cost == SOLVE_TOO_LARGE ) {
+            fprintf( stderr, "Graph of %ld nodes too large to solve in the sparse layout, at most %d\n",
+                    (long)graph_getNodeCount( graph ), SOLVE_SPARSE_NODES_MAX );
+            fmem_free( cliqueid );
+            graph_free( graph );
+            continue;
+        }
+        if( visual_getFormat() == VISUAL_FORMAT_TEXT ) {
+            printf( "Best cost: %ld\n", cost );
+        }
 
-            /* same graph everywhare, therefore accessed through graph */
-            DBGLONG( 1, beststate->cost );
-            printf( "Best cost: %ld\n", beststate->cost );
+        if( statistics && sched->jobs > 0 ) {
+            fprintf( stderr, "Algorithm: %s\nBranching: %s\nJobs: %ld\n",
+                    alg_name, branch_names[branching], sched->jobs );
+        } else if( statistics && sched->bitnodes > 0 ) {
+            fprintf( stderr, "Algorithm: %s\nSolver: bitset\nSearch nodes: %ld\n",
+                    alg_name, sched->bitnodes );
         }
-        cliqueid = postprocess_enumerate_cliques( graph, initstate );
+
+        /* Show, and validate, the cliques on the input graph */
         datasource_show( ds_store, graph, cliqueid );
         fmem_free( cliqueid );
-
-        graphstate_unlock( beststate );
-        graphstate_decref( beststate );
-
-        /*remove local reference to initstate*/
-        graphstate_decref( initstate );
-
         graph_free( graph );
-
-
     }
 
     /* Free data structures */
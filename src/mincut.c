@@ -0,0 +1,254 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+
+#include "debug.h"
+#include "graph.h"
+#include "graphstate.h"
+#include "fmem.h"
+#include "mincut.h"
+
+graphstate_t *mincut_edit( graphstate_t *gs, graph_chSet_t *chs );
+graphstate_t *mincut_component( graphstate_t *gs, const graph_t *graph, const graph_index_t *list, graph_size_t count, char *side );
+
+graph_cost_t mincut_stoerwagner( const graph_t *graph, const graph_index_t *list, graph_size_t count, char *side ) {
+    graph_cost_t    *w;     /* Positive weights between merged nodes */
+    graph_cost_t    *conn;  /* Connectivity to the set A of the phase */
+    graph_index_t   *next;  /* Linked lists of original nodes in a merged node */
+    graph_index_t   *last;
+    char            *exist;
+    char            *ina;
+    graph_cost_t    best;
+    graph_value_t   val;
+    graph_index_t   i, j, m, phase, sel, prev;
+
+    for( i = 0; i < count; i++ ) {
+        side[i] = 1;
+    }
+    if( count < 2 ) {
+        return 0;
+    }
+
+    w     = fmem_alloc_arr( sizeof( graph_cost_t ), count*count );
+    conn  = fmem_alloc_arr( sizeof( graph_cost_t ), count );
+    next  = fmem_alloc_arr( sizeof( graph_index_t ), count );
+    last  = fmem_alloc_arr( sizeof( graph_index_t ), count );
+    exist = fmem_alloc_arr( sizeof( char ), count );
+    ina   = fmem_alloc_arr( sizeof( char ), count );
+
+    for( i = 0; i < count; i++ ) {
+        w[i*count+i] = 0;
+        for( j = i+1; j < count; j++ ) {
+            val = graph_getValue( graph, list[i], list[j] );
+            w[i*count+j] = w[j*count+i] = val > 0 ? val : 0;
+        }
+        next[i] = -1;
+        last[i] = i;
+        exist[i] = 1;
+    }
+
+    best = -1;
+    for( phase = count; phase > 1; phase-- ) {
+        for( i = 0; i < count; i++ ) {
+            conn[i] = 0;
+            ina[i] = 0;
+        }
+
+        /* Grow A by the most tightly connected node */
+        prev = -1;
+        for( j = 0; j < phase; j++ ) {
+            sel = -1;
+            for( i = 0; i < count; i++ ) {
+                if( exist[i] && !ina[i] && ( sel < 0 || conn[i] > conn[sel] ) ) {
+                    sel = i;
+                }
+            }
+            ASSERT( sel >= 0 );
+
+            if( j < phase-1 ) {
+                ina[sel] = 1;
+                for( i = 0; i < count; i++ ) {
+                    conn[i] += w[sel*count+i];
+                }
+                prev = sel;
+                continue;
+            }
+
+            /* Cut of the phase separates the last node from the rest */
+            if( best < 0 || conn[sel] < best ) {
+                best = conn[sel];
+                for( i = 0; i < count; i++ ) {
+                    side[i] = 0;
+                }
+                for( m = sel; m >= 0; m = next[m] ) {
+                    side[m] = 1;
+                }
+            }
+
+            /* Merge the last two nodes */
+            for( i = 0; i < count; i++ ) {
+                w[prev*count+i] += w[sel*count+i];
+                w[i*count+prev] = w[prev*count+i];
+            }
+            w[prev*count+prev] = 0;
+            exist[sel] = 0;
+            next[last[prev]] = sel;
+            last[prev] = last[sel];
+        }
+    }
+
+    fmem_free( w );
+    fmem_free( conn );
+    fmem_free( next );
+    fmem_free( last );
+    fmem_free( exist );
+    fmem_free( ina );
+
+    return best;
+}
+
+graphstate_t *mincut_edit( graphstate_t *gs, graph_chSet_t *chs ) {
+    graphstate_t *newgs;
+    newgs = graphstate_create_chset( gs, chs );
+    graphstate_decref( gs );
+    return newgs;
+}
+
+/* Solve one component, if it is a near-clique.
+ *
+ * Any clustering with more than one cluster costs at least the minimum
+ * cut, so when the missing edges are cheaper the component is one cluster.
+ * Otherwise, if both sides of the minimum cut are cliques, the cut is an
+ * optimal clustering.
+ */
+graphstate_t *mincut_component( graphstate_t *gs, const graph_t *graph, const graph_index_t *list, graph_size_t count, char *side ) {
+    graph_index_t   i, j;
+    graph_value_t   val;
+    graph_size_t    missing;
+    graph_cost_t    missingcost, cut;
+
+    missing = 0;
+    missingcost = 0;
+    for( i = 0; i < count; i++ ) {
+        for( j = i+1; j < count; j++ ) {
+            val = graph_getValue( graph, list[i], list[j] );
+            if( val == 0 ) {
+                return gs; /* Zero-edges are priced by the algorithms */
+            } else if( val < 0 ) {
+                missing++;
+                missingcost -= val;
+            }
+        }
+    }
+
+    /* Cliques are already done, and sparse components are no near-cliques */
+    if( missing == 0 || missing > count ) {
+        return gs;
+    }
+
+    cut = mincut_stoerwagner( graph, list, count, side );
+
+    DBGLONG( 12, count );
+    DBGLONG( 12, missingcost );
+    DBGLONG( 12, cut );
+
+    if( missingcost <= cut ) {
+        /* Keep as one cluster */
+        for( i = 0; i < count; i++ ) {
+            for( j = i+1; j < count; j++ ) {
+                if( graph_getValue( graph, list[i], list[j] ) < 0 ) {
+                    gs = mincut_edit( gs, graph_setPersistant( graph, list[i], list[j] ) );
+                }
+            }
+        }
+        return gs;
+    }
+
+    for( i = 0; i < count; i++ ) {
+        for( j = i+1; j < count; j++ ) {
+            if( side[i] == side[j] && graph_getValue( graph, list[i], list[j] ) < 0 ) {
+                return gs;
+            }
+        }
+    }
+
+    /* Split along the cut */
+    for( i = 0; i < count; i++ ) {
+        for( j = i+1; j < count; j++ ) {
+            if( side[i] != side[j] && graph_getValue( graph, list[i], list[j] ) > 0 ) {
+                gs = mincut_edit( gs, graph_setForbidden( graph, list[i], list[j] ) );
+            }
+        }
+    }
+    return gs;
+}
+
+graphstate_t *mincut_reduce( graphstate_t *gs, const graph_model_t *model ) {
+    graphstate_t    *base;
+    graph_t         *graph;
+    graph_index_t   *comp;
+    graph_index_t   *list;
+    char            *side;
+    graph_index_t   i, a, b, start, head, count;
+
+    base = gs;
+    graphstate_lock( base, model );
+    graph = base->c.org->graph;
+
+    comp = fmem_alloc_arr( sizeof( graph_index_t ), graph_getNodeCount( graph ) );
+    list = fmem_alloc_arr( sizeof( graph_index_t ), graph_getNodeCount( graph ) );
+    side = fmem_alloc_arr( sizeof( char ), graph_getNodeCount( graph ) );
+
+    for( i = 0; i >= 0; i = graph_getNext( graph, i ) ) {
+        comp[i] = -1;
+    }
+
+    /* Breadth first search through positive edges, one component at a time.
+     * The states created for one component doesn't touch the graph, so all
+     * components are analysed in the locked base state.
+     */
+    count = 0;
+    for( i = 0; i >= 0; i = graph_getNext( graph, i ) ) {
+        if( comp[i] >= 0 ) {
+            continue;
+        }
+        start = count;
+        comp[i] = i;
+        list[count++] = i;
+        for( head = start; head < count; head++ ) {
+            a = list[head];
+            for( b = 0; b >= 0; b = graph_getNext( graph, b ) ) {
+                if( comp[b] < 0 && b != a && graph_getValue( graph, a, b ) > 0 ) {
+                    comp[b] = i;
+                    list[count++] = b;
+                }
+            }
+        }
+        if( count - start >= 3 ) {
+            gs = mincut_component( gs, graph, list + start, count - start, side );
+        }
+    }
+
+    fmem_free( comp );
+    fmem_free( list );
+    fmem_free( side );
+
+    graphstate_unlock( base );
+
+    return gs;
+}
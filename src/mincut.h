@@ -0,0 +1,42 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef MINCUT_H
+#define MINCUT_H
+
+#include "graph.h"
+#include "graphstate.h"
+
+/* Weighted global minimum cut (Stoer-Wagner) of the positive edges between
+ * the count nodes in list. One side of the cut is marked with 1 in side,
+ * indexed as list. Returns the weight of the cut.
+ */
+graph_cost_t mincut_stoerwagner( const graph_t *graph, const graph_index_t *list, graph_size_t count, char *side );
+
+/* Base case for near-cliques.
+ *
+ * Every connected component (through positive edges) that is a clique
+ * missing a few edges is solved exactly: if the weight of the missing
+ * edges is at most the minimum cut, the component is kept as one cluster,
+ * and if both sides of the minimum cut are cliques it is split along the
+ * cut. Components containing zero-edges are left to the algorithms.
+ *
+ * Takes over the reference to gs, and returns a reference to the new state.
+ */
+graphstate_t *mincut_reduce( graphstate_t *gs, const graph_model_t *model );
+
+#endif
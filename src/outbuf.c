@@ -0,0 +1,119 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <unistd.h>
+#include "debug.h"
+#include "fmem.h"
+#include "outbuf.h"
+
+#define OUTBUF_SIZE ( 1L << 16 )
+
+/* Room for any long, with sign */
+#define OUTBUF_LONG_MAX 24
+
+struct outbuf_t {
+    FILE    *fp;
+    int     fd;         /* Used if fp is NULL */
+    char    *buf;
+    size_t  len;
+    int     failed;
+};
+
+outbuf_t *outbuf_create( FILE *fp ) {
+    outbuf_t *ob = fmem_alloc( sizeof( outbuf_t ) );
+    ob->fp = fp;
+    ob->fd = -1;
+    ob->buf = fmem_alloc( OUTBUF_SIZE );
+    ob->len = 0;
+    ob->failed = 0;
+    return ob;
+}
+
+outbuf_t *outbuf_createFd( int fd ) {
+    outbuf_t *ob = outbuf_create( NULL );
+    ob->fd = fd;
+    return ob;
+}
+
+int outbuf_free( outbuf_t *ob ) {
+    int ok;
+
+    outbuf_flush( ob );
+    ok = !ob->failed && ( ob->fp == NULL || fflush( ob->fp ) == 0 );
+    fmem_free( ob->buf );
+    fmem_free( ob );
+    return ok;
+}
+
+void outbuf_flush( outbuf_t *ob ) {
+    size_t done;
+    ssize_t got;
+
+    if( ob->fp != NULL ) {
+        if( ob->len > 0 && fwrite( ob->buf, 1, ob->len, ob->fp ) != ob->len ) {
+            ob->failed = 1;
+        }
+    } else {
+        for( done = 0; done < ob->len && !ob->failed; done += got ) {
+            got = write( ob->fd, ob->buf + done, ob->len - done );
+            if( got <= 0 ) {
+                ob->failed = 1;
+            }
+        }
+    }
+    ob->len = 0;
+}
+
+void outbuf_putc( outbuf_t *ob, char c ) {
+    if( ob->len == OUTBUF_SIZE ) {
+        outbuf_flush( ob );
+    }
+    ob->buf[ob->len++] = c;
+}
+
+void outbuf_puts( outbuf_t *ob, const char *s ) {
+    while( *s != '\0' ) {
+        outbuf_putc( ob, *s++ );
+    }
+}
+
+void outbuf_putlong( outbuf_t *ob, long val, int width ) {
+    char digits[OUTBUF_LONG_MAX];
+    unsigned long mag;
+    int n = 0;
+
+    /* Negate unsigned, so that LONG_MIN works */
+    mag = val < 0 ? -(unsigned long)val : (unsigned long)val;
+    do {
+        digits[n++] = '0' + mag % 10;
+        mag /= 10;
+    } while( mag > 0 );
+    if( val < 0 ) {
+        digits[n++] = '-';
+    }
+
+    for( ; width > n; width-- ) {
+        outbuf_putc( ob, ' ' );
+    }
+    if( ob->len + n > OUTBUF_SIZE ) {
+        outbuf_flush( ob );
+    }
+    while( n > 0 ) {
+        ob->buf[ob->len++] = digits[--n];
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef OUTBUF_H
+#define OUTBUF_H
+
+#include <stdio.h>
+
+/* Buffered output with integer formatting, for writing graphs and
+ * solutions without a stdio call per number. Output written to the FILE
+ * directly must be preceded by outbuf_flush.
+ */
+typedef struct outbuf_t outbuf_t;
+
+outbuf_t *outbuf_create( FILE *fp );
+
+/* Writing to a file descriptor, like a socket, which is left open */
+outbuf_t *outbuf_createFd( int fd );
+
+/* Flush and free. Returns 0 if any write failed. */
+int outbuf_free( outbuf_t *ob );
+
+void outbuf_flush( outbuf_t *ob );
+
+void outbuf_putc( outbuf_t *ob, char c );
+void outbuf_puts( outbuf_t *ob, const char *s );
+
+/* val in decimal, right aligned to at least width characters */
+void outbuf_putlong( outbuf_t *ob, long val, int width );
+
+#endif
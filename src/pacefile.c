@@ -0,0 +1,250 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <limits.h>
+#include "debug.h"
+#include "fmem.h"
+#include "graphfile.h"
+#include "pacefile.h"
+
+/* Bytes read from a stream at a time */
+#define PACEFILE_BLOCK ( 1L << 16 )
+
+/* Numbers kept from a line */
+#define PACEFILE_FIELDS 2
+
+/* Where in a line the scanner is */
+#define PACEFILE_START   0  /* Before the first character */
+#define PACEFILE_SKIP    1  /* In a comment or a bad line */
+#define PACEFILE_KEYWORD 2  /* In the format name of the "p" line */
+#define PACEFILE_FIELD   3  /* Between or in numbers */
+
+static const char pacefile_keyword[] = "cep";
+#define PACEFILE_KEYWORD_LEN ( (int)sizeof( pacefile_keyword ) - 1 )
+
+/* The scanner keeps its state between blocks, so lines may be split
+ * anywhere
+ */
+typedef struct pacefile_t {
+    graph_t     *graph;
+    long        line;
+    int         state;
+    int         header;     /* Line is the "p" line */
+    int         kwpos;      /* Characters of the keyword matched, -2 right
+                             * after the "p" and -1 in blanks before it */
+    int         cnt;        /* Numbers started on the line */
+    int         innum;      /* Last character was a digit */
+    long        vals[PACEFILE_FIELDS];
+    long        edges;      /* Edges announced by the "p" line */
+    long        found;      /* Edge lines read */
+} pacefile_t;
+
+void pacefile_init( pacefile_t *pf );
+void pacefile_error( pacefile_t *pf, const char *msg );
+void pacefile_endline( pacefile_t *pf );
+void pacefile_feed( pacefile_t *pf, const char *data, size_t size );
+graph_t *pacefile_finish( pacefile_t *pf );
+
+
+int pacefile_detect( const char *data, size_t size ) {
+    size_t i = 0;
+
+    while( i < size && ( data[i] == ' ' || data[i] == '\t' || data[i] == '\r' || data[i] == '\n' ) ) {
+        i++;
+    }
+    return i + 1 < size && ( data[i] == 'c' || data[i] == 'p' ) &&
+        ( data[i+1] == ' ' || data[i+1] == '\t' || data[i+1] == '\r' || data[i+1] == '\n' );
+}
+
+void pacefile_init( pacefile_t *pf ) {
+    pf->graph = NULL;
+    pf->line = 1;
+    pf->state = PACEFILE_START;
+    pf->edges = 0;
+    pf->found = 0;
+}
+
+void pacefile_error( pacefile_t *pf, const char *msg ) {
+    fprintf( stderr, "Line %ld: %s\n", pf->line, msg );
+    pf->state = PACEFILE_SKIP;
+}
+
+/* Handle the numbers of a complete line */
+void pacefile_endline( pacefile_t *pf ) {
+    if( pf->state == PACEFILE_KEYWORD ) {
+        pacefile_error( pf, "expected \"p cep nodes edges\"" );
+    }
+    if( pf->state != PACEFILE_FIELD ) {
+        return;
+    }
+
+    if( pf->header ) {
+        if( pf->cnt != 2 || pf->vals[0] < 0 || pf->vals[1] < 0 ) {
+            pacefile_error( pf, "expected \"p cep nodes edges\"" );
+        } else if( pf->graph != NULL ) {
+            pacefile_error( pf, "more than one \"p\" line" );
+        } else if( pf->vals[0] > graphfile_getMaxNodes() ) {
+            pacefile_error( pf, "too many nodes" );
+        } else {
+            pf->graph = graph_create( pf->vals[0] );
+            pf->edges = pf->vals[1];
+        }
+    } else if( pf->cnt != 2 ) {
+        pacefile_error( pf, "expected \"node node\"" );
+    } else if( pf->graph == NULL ) {
+        pacefile_error( pf, "edge before the \"p\" line" );
+    } else if( pf->vals[0] < 1 || pf->vals[0] > graph_getNodeCount( pf->graph ) ||
+            pf->vals[1] < 1 || pf->vals[1] > graph_getNodeCount( pf->graph ) ) {
+        pacefile_error( pf, "node out of range" );
+    } else if( pf->vals[0] == pf->vals[1] ) {
+        pacefile_error( pf, "edge from a node to itself" );
+    } else {
+        graph_setValue( pf->graph, pf->vals[0] - 1, pf->vals[1] - 1, 1 );
+        pf->found++;
+    }
+}
+
+void pacefile_feed( pacefile_t *pf, const char *data, size_t size ) {
+    const char *p = data, *end = data + size;
+    int digit;
+
+    while( p < end ) {
+        if( *p == '\n' ) {
+            pacefile_endline( pf );
+            pf->state = PACEFILE_START;
+            pf->line++;
+            p++;
+            continue;
+        }
+
+        switch( pf->state ) {
+            case PACEFILE_START:
+                pf->header = 0;
+                pf->cnt = 0;
+                pf->innum = 0;
+                if( *p == 'c' ) {
+                    pf->state = PACEFILE_SKIP;
+                } else if( *p == 'p' ) {
+                    pf->header = 1;
+                    pf->kwpos = -2;
+                    pf->state = PACEFILE_KEYWORD;
+                } else if( *p >= '0' && *p <= '9' ) {
+                    pf->state = PACEFILE_FIELD;
+                    continue;
+                } else if( *p != ' ' && *p != '\t' && *p != '\r' ) {
+                    pacefile_error( pf, "expected \"node node\"" );
+                }
+                p++;
+                break;
+
+            case PACEFILE_SKIP:
+                /* Skip to the end of the line */
+                while( p < end && *p != '\n' ) {
+                    p++;
+                }
+                break;
+
+            case PACEFILE_KEYWORD:
+                /* A blank after the "p", the keyword, then a blank */
+                if( *p == ' ' || *p == '\t' || *p == '\r' ) {
+                    if( pf->kwpos == PACEFILE_KEYWORD_LEN ) {
+                        pf->state = PACEFILE_FIELD;
+                    } else if( pf->kwpos == -2 ) {
+                        pf->kwpos = -1;
+                    } else if( pf->kwpos >= 0 ) {
+                        pacefile_error( pf, "expected \"p cep nodes edges\"" );
+                    }
+                } else if( pf->kwpos == -1 ) {
+                    pf->kwpos = 0;
+                    continue;
+                } else if( pf->kwpos >= 0 && pf->kwpos < PACEFILE_KEYWORD_LEN &&
+                        *p == pacefile_keyword[pf->kwpos] ) {
+                    pf->kwpos++;
+                } else {
+                    pacefile_error( pf, "expected \"p cep nodes edges\"" );
+                }
+                p++;
+                break;
+
+            case PACEFILE_FIELD:
+                /* The numbers of edge lines, scanned in a tight loop */
+                while( p < end && *p >= '0' && *p <= '9' ) {
+                    if( !pf->innum ) {
+                        pf->innum = 1;
+                        if( pf->cnt < PACEFILE_FIELDS ) {
+                            pf->vals[pf->cnt] = 0;
+                        }
+                        pf->cnt++;
+                    }
+                    if( pf->cnt <= PACEFILE_FIELDS ) {
+                        digit = *p - '0';
+                        if( pf->vals[pf->cnt-1] > ( LONG_MAX - digit ) / 10 ) {
+                            pacefile_error( pf, "number too large" );
+                            break;
+                        }
+                        pf->vals[pf->cnt-1] = pf->vals[pf->cnt-1] * 10 + digit;
+                    }
+                    p++;
+                }
+                if( p == end || pf->state != PACEFILE_FIELD || *p == '\n' ) {
+                    break;
+                }
+                if( *p == ' ' || *p == '\t' || *p == '\r' ) {
+                    pf->innum = 0;
+                    p++;
+                } else {
+                    pacefile_error( pf, pf->header ? "expected \"p cep nodes edges\"" : "expected \"node node\"" );
+                }
+                break;
+        }
+    }
+}
+
+/* End the last line, and hand over the graph */
+graph_t *pacefile_finish( pacefile_t *pf ) {
+    pacefile_endline( pf );
+    if( pf->graph == NULL ) {
+        fprintf( stderr, "Line %ld: expected \"p cep nodes edges\"\n", pf->line );
+    } else if( pf->found != pf->edges ) {
+        fprintf( stderr, "Expected %ld edges, read %ld\n", pf->edges, pf->found );
+    }
+    return pf->graph;
+}
+
+
+graph_t *pacefile_readmem( const char *data, size_t size ) {
+    pacefile_t pf;
+
+    pacefile_init( &pf );
+    pacefile_feed( &pf, data, size );
+    return pacefile_finish( &pf );
+}
+
+graph_t *pacefile_readfobj( FILE *fp ) {
+    pacefile_t pf;
+    char *block;
+    size_t got;
+
+    block = fmem_alloc( PACEFILE_BLOCK );
+    pacefile_init( &pf );
+    while( ( got = fread( block, 1, PACEFILE_BLOCK, fp ) ) > 0 ) {
+        pacefile_feed( &pf, block, got );
+    }
+    fmem_free( block );
+    return pacefile_finish( &pf );
+}
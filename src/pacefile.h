@@ -0,0 +1,40 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef PACEFILE_H
+#define PACEFILE_H
+
+#include <stdio.h>
+#include "graph.h"
+
+/* Graphs in the PACE cluster editing format: comment lines starting with
+ * "c", a "p cep <nodes> <edges>" line and then "u v" per edge, with nodes
+ * numbered from 1. Edges are stored as 1 and all other pairs are left -1,
+ * so sparse graphs stay sparse.
+ */
+
+/* If data, the start of a file, looks like a PACE file */
+int pacefile_detect( const char *data, size_t size );
+
+/* Read a graph. The input is scanned as it arrives, without collecting
+ * lines. Bad lines are reported with their line number on stderr, and
+ * skipped. Returns NULL if there is no "p" line.
+ */
+graph_t *pacefile_readmem( const char *data, size_t size );
+graph_t *pacefile_readfobj( FILE *fp );
+
+#endif
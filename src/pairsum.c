@@ -0,0 +1,511 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "debug.h"
+#include "graph.h"
+#include "fmem.h"
+#include "pairsum.h"
+
+#define PAIRSUM_SIGNOF( _V ) ( (_V) > 0 ? 1 : ( (_V) < 0 ? -1 : 0 ) )
+
+/* Score of the triple (a,b,c), with the lower node of the pair first */
+#define PAIRSUM_SCORE( _PS, _A, _B, _AB, _AC, _BC ) \
+    ( (_A) < (_B) ? (*(_PS)->score)( (_AB), (_AC), (_BC) ) : (*(_PS)->score)( (_AB), (_BC), (_AC) ) )
+
+void pairsum_before( void *storage, const graph_t *graph, int op, graph_index_t n1, graph_index_t n2 );
+void pairsum_after( void *storage, const graph_t *graph, int op, graph_index_t n1, graph_index_t n2 );
+void pairsum_free( void *storage );
+graph_cost_t pairsum_calculate( pairsum_t *ps, const graph_t *graph, graph_index_t a, graph_index_t b, const graph_value_t *rowa, const graph_value_t *rowb );
+graph_cost_t pairsum_countSigns( pairsum_t *ps, const graph_t *graph, graph_index_t a, graph_index_t b, graph_value_t ab );
+void pairsum_updateEdge( pairsum_t *ps, const graph_t *graph, graph_index_t n1, graph_index_t n2 );
+void pairsum_addRow( pairsum_t *ps, const graph_t *graph, graph_index_t node, const graph_value_t *row, graph_index_t other, int sign );
+void pairsum_setSum( pairsum_t *ps, graph_index_t a, graph_index_t b, graph_cost_t sum );
+void pairsum_removeNode( pairsum_t *ps, const graph_t *graph, graph_index_t n );
+void pairsum_setBest( pairsum_t *ps, graph_index_t idx, double best, graph_index_t third );
+void pairsum_rescore( pairsum_t *ps, const graph_t *graph, graph_index_t a, graph_index_t b, const graph_value_t *rowa, const graph_value_t *rowb );
+
+static const graph_listener_t pairsum_listener = {
+    pairsum_before,
+    pairsum_after,
+    pairsum_free
+};
+
+pairsum_t *pairsum_get( graph_t *graph, pairsum_term_t term, pairsum_score_t score, int flags ) {
+    pairsum_t *ps;
+    graph_index_t a, b;
+    graph_size_t edges, i, j, nodes;
+    graph_cost_t sum;
+    const graph_index_t *active;
+    int n, loaded, signs;
+
+    ASSERT( score == NULL || ( flags & PAIRSUM_TRACK ) );
+    for( n = 0; (ps = graph_getListener( graph, &pairsum_listener, n )) != NULL; n++ ) {
+        if( ps->term == term && ps->score == score && ps->flags == flags ) {
+            break;
+        }
+    }
+
+    if( ps == NULL ) {
+        edges = graph_getEdgeCount( graph ) + 1;
+        ps = fmem_alloc( sizeof( pairsum_t ) );
+        ps->term  = term;
+        ps->flags = flags;
+        ps->sum   = fmem_alloc_arr( sizeof( graph_cost_t ), edges );
+        ps->row1  = fmem_alloc_arr( sizeof( graph_value_t ), graph->nodes );
+        ps->row2  = fmem_alloc_arr( sizeof( graph_value_t ), graph->nodes );
+        ps->row3  = fmem_alloc_arr( sizeof( graph_value_t ), graph->nodes );
+        ps->dirty = fmem_alloc_arr( sizeof( char ), graph->nodes );
+        ps->changed = fmem_alloc_arr( sizeof( graph_size_t ), graph->nodes );
+        for( a = 0; a < graph->nodes; a++ ) {
+            ps->dirty[a] = 1;
+            ps->changed[a] = 0;
+        }
+        ps->count = NULL;
+        ps->pairs = 0;
+        if( flags & PAIRSUM_TRACK ) {
+            ps->count = fmem_alloc_arr( sizeof( graph_size_t ), graph->nodes );
+            for( a = 0; a < graph->nodes; a++ ) {
+                ps->count[a] = 0;
+            }
+            for( a = 0; a < edges; a++ ) {
+                ps->sum[a] = 0;
+            }
+        }
+        ps->score = score;
+        ps->best  = NULL;
+        ps->third = NULL;
+        ps->stale = 0;
+        if( score != NULL ) {
+            ps->best  = fmem_alloc_arr( sizeof( double ), edges );
+            ps->third = fmem_alloc_arr( sizeof( graph_index_t ), edges );
+            for( a = 0; a < edges; a++ ) {
+                ps->third[a] = -1;
+            }
+        }
+        graph_addListener( graph, &pairsum_listener, ps );
+        if( flags & PAIRSUM_SIGN ) {
+            graph_enableSigns( graph );
+        }
+    }
+
+    /* Recalculate all pairs containing a dirty node, from the rows of the
+     * pair, or counting the third nodes a word at a time from the signs
+     */
+    signs = ( flags & PAIRSUM_SIGN ) && graph_hasSigns( graph );
+    for( a = 0; a >= 0; a = graph_getNext( graph, a ) ) {
+        if( !ps->dirty[a] ) {
+            continue;
+        }
+        graph_getRow( graph, a, ps->row1 );
+        for( b = 0; b >= 0; b = graph_getNext( graph, b ) ) {
+            /* Pairs of two dirty nodes are calculated from the first one */
+            if( b == a || ( ps->dirty[b] && b < a ) ) {
+                continue;
+            }
+            if( signs ) {
+                sum = pairsum_countSigns( ps, graph, a, b, ps->row1[b] );
+            } else {
+                graph_getRow( graph, b, ps->row2 );
+                sum = pairsum_calculate( ps, graph, a, b, ps->row1, ps->row2 );
+            }
+            pairsum_setSum( ps, a, b, sum );
+            if( score != NULL && sum != 0 ) {
+                if( signs ) {
+                    graph_getRow( graph, b, ps->row2 );
+                }
+                pairsum_rescore( ps, graph, a, b, ps->row1, ps->row2 );
+            }
+        }
+    }
+    for( a = 0; a < graph->nodes; a++ ) {
+        ps->dirty[a] = 0;
+        ps->changed[a] = 0;
+    }
+
+    /* Scan the third nodes of pairs whose best one has disappeared */
+    if( ps->stale > 0 ) {
+        active = graph_getActive( graph );
+        nodes = graph_getActiveCount( graph );
+        for( i = 0; i < nodes; i++ ) {
+            a = active[i];
+            loaded = 0;
+            for( j = i + 1; j < nodes; j++ ) {
+                b = active[j];
+                if( pairsum_getBestThird( ps, a, b ) != PAIRSUM_STALE ) {
+                    continue;
+                }
+                if( !loaded ) {
+                    graph_getRow( graph, a, ps->row1 );
+                    loaded = 1;
+                }
+                graph_getRow( graph, b, ps->row2 );
+                pairsum_rescore( ps, graph, a, b, ps->row1, ps->row2 );
+            }
+        }
+        ASSERT( ps->stale == 0 );
+    }
+
+    return ps;
+}
+
+void pairsum_free( void *storage ) {
+    pairsum_t *ps = (pairsum_t *)storage;
+    fmem_free( ps->sum );
+    fmem_free( ps->row1 );
+    fmem_free( ps->row2 );
+    fmem_free( ps->row3 );
+    fmem_free( ps->dirty );
+    fmem_free( ps->changed );
+    if( ps->count != NULL ) {
+        fmem_free( ps->count );
+    }
+    if( ps->score != NULL ) {
+        fmem_free( ps->best );
+        fmem_free( ps->third );
+    }
+    fmem_free( ps );
+}
+
+int pairsum_getTriple( pairsum_t *ps, const graph_t *graph, graph_index_t *a, graph_index_t *b, graph_index_t *c ) {
+    const graph_index_t *active = graph_getActive( graph );
+    graph_size_t i, j, n = graph_getActiveCount( graph );
+
+    ASSERT( ps->count != NULL );
+    if( ps->pairs == 0 ) {
+        return 0;
+    }
+
+    /* The active nodes are in order of index, so the lowest node of the
+     * first pair is the first node in any pair, and the other nodes paired
+     * with it are all after it
+     */
+    for( i = 0; ps->count[active[i]] == 0; i++ ) {
+        ASSERT( i + 1 < n );
+    }
+    *a = active[i];
+    for( j = i + 1; pairsum_getValue( ps, *a, active[j] ) == 0; j++ ) {
+        ASSERT( j + 1 < n );
+    }
+    *b = active[j];
+
+    *c = pairsum_getThird( ps, graph, *a, *b );
+    ASSERT( *c >= 0 ); /* A nonzero sum has a nonzero term */
+    return *c >= 0;
+}
+
+graph_index_t pairsum_getThird( pairsum_t *ps, const graph_t *graph, graph_index_t a, graph_index_t b ) {
+    graph_value_t ab;
+    graph_index_t c, first;
+    const graph_index_t *active = graph_getActive( graph );
+    graph_size_t i, n = graph_getActiveCount( graph );
+    int sc1, sc2;
+
+    ab = graph_getValue( graph, a, b );
+
+    /* The lowest node of every sign combination with a nonzero term */
+    if( ( ps->flags & PAIRSUM_SIGN ) && graph_hasSigns( graph ) ) {
+        first = -1;
+        for( sc1 = -1; sc1 <= 1; sc1++ ) {
+            for( sc2 = -1; sc2 <= 1; sc2++ ) {
+                if( (*ps->term)( ab, sc1, sc2 ) == 0 ) {
+                    continue;
+                }
+                c = graph_firstSigns( graph, a, sc1, b, sc2 );
+                if( c >= 0 && ( first < 0 || c < first ) ) {
+                    first = c;
+                }
+            }
+        }
+        return first;
+    }
+
+    graph_getRow( graph, a, ps->row1 );
+    graph_getRow( graph, b, ps->row2 );
+    for( i = 0; i < n; i++ ) {
+        c = active[i];
+        if( c != a && c != b && (*ps->term)( ab, ps->row1[c], ps->row2[c] ) != 0 ) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+void pairsum_setSum( pairsum_t *ps, graph_index_t a, graph_index_t b, graph_cost_t sum ) {
+    graph_index_t idx;
+
+    idx = GRAPH_EDGE_IDX( a, b );
+    if( ps->count != NULL && ( ps->sum[idx] != 0 ) != ( sum != 0 ) ) {
+        if( sum != 0 ) {
+            ps->count[a]++;
+            ps->count[b]++;
+            ps->pairs++;
+        } else {
+            ps->count[a]--;
+            ps->count[b]--;
+            ps->pairs--;
+        }
+    }
+    ps->sum[idx] = sum;
+    if( ps->score != NULL && sum == 0 ) {
+        pairsum_setBest( ps, idx, 0.0, -1 );
+    }
+}
+
+void pairsum_setBest( pairsum_t *ps, graph_index_t idx, double best, graph_index_t third ) {
+    if( ps->third[idx] == PAIRSUM_STALE ) {
+        ps->stale--;
+    }
+    if( third == PAIRSUM_STALE ) {
+        ps->stale++;
+    }
+    ps->best[idx] = best;
+    ps->third[idx] = third;
+}
+
+/* Find the best third node of (a,b), whose edges are in rowa and rowb */
+void pairsum_rescore( pairsum_t *ps, const graph_t *graph, graph_index_t a, graph_index_t b, const graph_value_t *rowa, const graph_value_t *rowb ) {
+    graph_index_t c, third = -1;
+    graph_value_t ab;
+    double score, best = 0.0;
+    const graph_index_t *active = graph_getActive( graph );
+    graph_size_t i, n = graph_getActiveCount( graph );
+
+    if( pairsum_getValue( ps, a, b ) != 0 ) {
+        ab = rowa[b];
+        for( i = 0; i < n; i++ ) {
+            c = active[i];
+            if( c == a || c == b || (*ps->term)( ab, rowa[c], rowb[c] ) == 0 ) {
+                continue;
+            }
+            score = PAIRSUM_SCORE( ps, a, b, ab, rowa[c], rowb[c] );
+            if( third < 0 || score < best ) {
+                best = score;
+                third = c;
+            }
+        }
+    }
+    pairsum_setBest( ps, GRAPH_EDGE_IDX( a, b ), best, third );
+}
+
+/* Remove all pairs containing n from the set, as n is no longer active */
+void pairsum_removeNode( pairsum_t *ps, const graph_t *graph, graph_index_t n ) {
+    graph_index_t a;
+
+    if( ps->count == NULL || ps->count[n] == 0 ) {
+        return;
+    }
+    for( a = 0; a >= 0; a = graph_getNext( graph, a ) ) {
+        if( a != n ) {
+            pairsum_setSum( ps, a, n, 0 );
+        }
+    }
+}
+
+/* Sum of the terms of (a,b), whose edges are in rowa and rowb */
+graph_cost_t pairsum_calculate( pairsum_t *ps, const graph_t *graph, graph_index_t a, graph_index_t b, const graph_value_t *rowa, const graph_value_t *rowb ) {
+    graph_cost_t sum = 0;
+    graph_value_t ab;
+    graph_index_t c;
+    const graph_index_t *active = graph_getActive( graph );
+    graph_size_t i, n = graph_getActiveCount( graph );
+
+    ab = rowa[b];
+    for( i = 0; i < n; i++ ) {
+        c = active[i];
+        if( c != a && c != b ) {
+            sum += (*ps->term)( ab, rowa[c], rowb[c] );
+        }
+    }
+    return sum;
+}
+
+/* Sum of the terms of (a,b), for terms that only depend on the signs of
+ * the edges, counting the third nodes of every sign combination a word at
+ * a time
+ */
+graph_cost_t pairsum_countSigns( pairsum_t *ps, const graph_t *graph, graph_index_t a, graph_index_t b, graph_value_t ab ) {
+    graph_cost_t sum = 0, term;
+    int sc1, sc2;
+
+    for( sc1 = -1; sc1 <= 1; sc1++ ) {
+        for( sc2 = -1; sc2 <= 1; sc2++ ) {
+            term = (*ps->term)( ab, sc1, sc2 );
+            if( term != 0 ) {
+                sum += term * graph_countSigns( graph, a, sc1, b, sc2 );
+            }
+        }
+    }
+    return sum;
+}
+
+/* The edge (n1,n2) changed from ps->edge. The sum of (n1,n2) is calculated
+ * again, and in the other pairs containing n1 or n2 only the term of the
+ * other node changes, in O(N) in all.
+ */
+void pairsum_updateEdge( pairsum_t *ps, const graph_t *graph, graph_index_t n1, graph_index_t n2 ) {
+    graph_index_t c;
+    graph_value_t old, edge;
+    graph_cost_t diff;
+    const graph_index_t *active = graph_getActive( graph );
+    graph_size_t i, n = graph_getActiveCount( graph );
+
+    graph_getRow( graph, n1, ps->row1 );
+    graph_getRow( graph, n2, ps->row2 );
+    old = ps->edge;
+    edge = ps->row1[n2];
+    for( i = 0; i < n; i++ ) {
+        c = active[i];
+        if( c == n1 || c == n2 || ps->dirty[c] ) {
+            continue;
+        }
+        if( !ps->dirty[n1] ) {
+            diff = (*ps->term)( ps->row1[c], edge, ps->row2[c] ) - (*ps->term)( ps->row1[c], old, ps->row2[c] );
+            if( diff != 0 ) {
+                pairsum_setSum( ps, n1, c, pairsum_getValue( ps, n1, c ) + diff );
+            }
+        }
+        if( !ps->dirty[n2] ) {
+            diff = (*ps->term)( ps->row2[c], edge, ps->row1[c] ) - (*ps->term)( ps->row2[c], old, ps->row1[c] );
+            if( diff != 0 ) {
+                pairsum_setSum( ps, n2, c, pairsum_getValue( ps, n2, c ) + diff );
+            }
+        }
+    }
+    if( !ps->dirty[n1] && !ps->dirty[n2] ) {
+        pairsum_setSum( ps, n1, n2, pairsum_calculate( ps, graph, n1, n2, ps->row1, ps->row2 ) );
+    }
+}
+
+/* Add (or remove) the term of node, whose edges are in row, to all clean
+ * pairs not containing node or other.
+ */
+void pairsum_addRow( pairsum_t *ps, const graph_t *graph, graph_index_t node, const graph_value_t *row, graph_index_t other, int sign ) {
+    graph_index_t a, b, idx;
+    graph_value_t ab;
+    graph_cost_t term;
+    double score;
+    const graph_index_t *active = graph_getActive( graph );
+    graph_size_t i, j, n = graph_getActiveCount( graph );
+
+    for( i = 0; i < n; i++ ) {
+        a = active[i];
+        if( a == node || a == other || ps->dirty[a] ) {
+            continue;
+        }
+        graph_getRow( graph, a, ps->row3 );
+        for( j = i + 1; j < n; j++ ) {
+            b = active[j];
+            if( b == node || b == other || ps->dirty[b] ) {
+                continue;
+            }
+            ab = ps->row3[b];
+            term = (*ps->term)( ab, row[a], row[b] );
+            if( term == 0 ) {
+                continue;
+            }
+            pairsum_setSum( ps, a, b, pairsum_getValue( ps, a, b ) + ( sign > 0 ? term : -term ) );
+            if( ps->score == NULL ) {
+                continue;
+            }
+
+            /* The best third node of a pair can only get worse when a node
+             * disappears, or be the new node
+             */
+            idx = GRAPH_EDGE_IDX( a, b );
+            if( sign < 0 ) {
+                if( ps->third[idx] == node ) {
+                    pairsum_setBest( ps, idx, 0.0, PAIRSUM_STALE );
+                }
+            } else if( ps->third[idx] != PAIRSUM_STALE ) {
+                score = PAIRSUM_SCORE( ps, a, b, ab, row[a], row[b] );
+                if( ps->third[idx] < 0 || score < ps->best[idx] ) {
+                    pairsum_setBest( ps, idx, score, node );
+                }
+            }
+        }
+    }
+}
+
+void pairsum_before( void *storage, const graph_t *graph, int op, graph_index_t n1, graph_index_t n2 ) {
+    pairsum_t *ps = (pairsum_t *)storage;
+
+    switch( op ) {
+        case GRAPH_OP_MERGE:
+            /* n1 and n2 disappears as third nodes */
+            graph_getRow( graph, n1, ps->row1 );
+            graph_getRow( graph, n2, ps->row2 );
+            pairsum_addRow( ps, graph, n1, ps->row1, n2, -1 );
+            pairsum_addRow( ps, graph, n2, ps->row2, n1, -1 );
+            break;
+        case GRAPH_OP_SPLIT:
+            /* The merged n1 disappears as third node */
+            graph_getRow( graph, n1, ps->row1 );
+            pairsum_addRow( ps, graph, n1, ps->row1, -1, -1 );
+            break;
+        default:
+            ps->edge = graph_getValue( graph, n1, n2 );
+            break;
+    }
+}
+
+void pairsum_after( void *storage, const graph_t *graph, int op, graph_index_t n1, graph_index_t n2 ) {
+    pairsum_t *ps = (pairsum_t *)storage;
+
+    switch( op ) {
+        case GRAPH_OP_MERGE:
+            graph_getRow( graph, n1, ps->row1 );
+            pairsum_addRow( ps, graph, n1, ps->row1, -1, 1 );
+            pairsum_removeNode( ps, graph, n2 );
+            ps->dirty[n1] = 1;
+            break;
+        case GRAPH_OP_SPLIT:
+            graph_getRow( graph, n1, ps->row1 );
+            graph_getRow( graph, n2, ps->row2 );
+            pairsum_addRow( ps, graph, n1, ps->row1, n2, 1 );
+            pairsum_addRow( ps, graph, n2, ps->row2, n1, 1 );
+            ps->dirty[n1] = 1;
+            ps->dirty[n2] = 1;
+            break;
+        default:
+            if( ps->score != NULL ) {
+                /* Only pairs containing n1 or n2 depends on the edge
+                 * (n1,n2), and so do the scores of their triples
+                 */
+                ps->dirty[n1] = 1;
+                ps->dirty[n2] = 1;
+                break;
+            }
+            if( ( ps->flags & PAIRSUM_SIGN ) &&
+                    PAIRSUM_SIGNOF( ps->edge ) == PAIRSUM_SIGNOF( graph_getValue( graph, n1, n2 ) ) ) {
+                break;
+            }
+            /* Replaying changesets sets many edges of the same nodes. Once
+             * more than N/16 edges of a node have changed, recalculating
+             * its pairs once when fetched is cheaper than following them.
+             */
+            if( ++ps->changed[n1] > graph_getActiveCount( graph ) / 16 ) {
+                ps->dirty[n1] = 1;
+            }
+            if( ++ps->changed[n2] > graph_getActiveCount( graph ) / 16 ) {
+                ps->dirty[n2] = 1;
+            }
+            if( !ps->dirty[n1] || !ps->dirty[n2] ) {
+                pairsum_updateEdge( ps, graph, n1, n2 );
+            }
+            break;
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef PAIRSUM_H
+#define PAIRSUM_H
+
+#include "graph.h"
+
+/* Term for a third node c, given the edges (a,b), (a,c) and (b,c). Must be
+ * symmetric in the last two arguments.
+ */
+typedef graph_cost_t (*pairsum_term_t)( graph_value_t, graph_value_t, graph_value_t );
+
+/* Score of the triple given its edges (a,b), (a,c) and (b,c), lower is
+ * better. The lower node of the pair is always passed as a.
+ */
+typedef double (*pairsum_score_t)( graph_value_t, graph_value_t, graph_value_t );
+
+/* For every pair of active nodes (a,b), the sum of term over all other
+ * active nodes c. The sums are attached to the graph and kept up to date
+ * as changesets are applied, in O(N^2) per merge or split and O(N) per
+ * changed edge, instead of being recalculated in O(N^3). Merged and split
+ * nodes, and nodes with many changed edges, are only marked as dirty, and
+ * their pairs are recalculated once when the sums are fetched, in O(N) per
+ * pair from rows.
+ *
+ * Optionally the pairs with a nonzero sum are tracked, for example to find
+ * a conflict triple in O(N) instead of searching the graph. The sums
+ * themselves tell which pairs are in the set, only the number of such
+ * pairs per node is kept on the side.
+ *
+ * With a score, the third node with the lowest score among those with a
+ * nonzero term is also kept for every tracked pair. This takes a term that
+ * is never negative, so that a pair with a zero sum has no such node. When
+ * the best third node of a pair disappears the pair is only marked stale,
+ * and its third nodes are scanned again when the sums are fetched. Any
+ * change of an edge marks its nodes dirty, as the scores of the triples
+ * containing it change even if the terms don't.
+ */
+/* Flags */
+#define PAIRSUM_TRACK   1   /* Track the set of pairs with nonzero sum */
+#define PAIRSUM_SIGN    2   /* The term only depends on the signs of the edges,
+                             * sums are counted with the graph sign planes */
+
+typedef struct pairsum_t {
+    pairsum_term_t  term;
+    int             flags;
+    graph_cost_t    *sum;   /* Indexed by GRAPH_EDGE_IDX */
+    graph_value_t   *row1;  /* Scratch rows, indexed by node */
+    graph_value_t   *row2;
+    graph_value_t   *row3;
+    char            *dirty; /* Pairs containing the node are outdated */
+    graph_size_t    *changed; /* Edges of the node changed since fetched */
+    graph_value_t   edge;   /* Previous value of an edge being set */
+
+    /* Pairs with nonzero sum, NULL if not tracked */
+    graph_size_t    *count; /* Pairs containing the node, indexed by node */
+    graph_size_t    pairs;
+
+    /* Best third node of tracked pairs, NULL if not scored */
+    pairsum_score_t score;
+    double          *best;  /* Lowest score; by GRAPH_EDGE_IDX */
+    graph_index_t   *third; /* Its third node, -1 if none, or PAIRSUM_STALE */
+    graph_size_t    stale;  /* Number of stale pairs */
+} pairsum_t;
+
+#define PAIRSUM_STALE (-2)
+
+/* Fetch the sums for term, and the best third nodes by score unless it is
+ * NULL, attached to graph, calculating them the first time and bringing
+ * them up to date otherwise. The graph owns the result.
+ */
+pairsum_t *pairsum_get( graph_t *graph, pairsum_term_t term, pairsum_score_t score, int flags );
+
+/* Fetch the first pair in node order from the set of pairs with a nonzero
+ * sum, and the first third node with a nonzero term for it. Finding the
+ * pair reads the node counts and the sums up to it, at most O(N). The
+ * third node is found as by pairsum_getThird. Returns 0 if the set is
+ * empty.
+ */
+int pairsum_getTriple( pairsum_t *ps, const graph_t *graph, graph_index_t *a, graph_index_t *b, graph_index_t *c );
+
+/* First third node c of the pair (a,b) with a nonzero term, or -1. With
+ * PAIRSUM_SIGN this takes O(N/64) per sign combination with a nonzero
+ * term, from the sign planes. Otherwise both rows are loaded with
+ * graph_getRow, in O(N), and scanned up to c.
+ */
+graph_index_t pairsum_getThird( pairsum_t *ps, const graph_t *graph, graph_index_t a, graph_index_t b );
+
+#define pairsum_getValue( _PS, _A, _B ) ( (_PS)->sum[ GRAPH_EDGE_IDX( (_A), (_B) ) ] )
+
+/* Lowest score of the third nodes of a scored pair, and that node */
+#define pairsum_getBest( _PS, _A, _B ) ( (_PS)->best[ GRAPH_EDGE_IDX( (_A), (_B) ) ] )
+#define pairsum_getBestThird( _PS, _A, _B ) ( (_PS)->third[ GRAPH_EDGE_IDX( (_A), (_B) ) ] )
+
+/* Number of tracked pairs containing the node */
+#define pairsum_getNodePairs( _PS, _N ) ( (_PS)->count[_N] )
+
+/* Number of pairs with a nonzero sum, if tracked */
+#define pairsum_getPairCount( _PS ) ( (_PS)->pairs )
+
+#endif
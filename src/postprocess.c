@@ -24,8 +24,10 @@
 
 graph_index_t *postprocess_enumerate_cliques( graph_t *graph, graphstate_t *basestate ) {
     graph_index_t *cliqueid;
+    const graph_index_t *active;
 
     graph_index_t c_id,i,j;
+    graph_size_t k,l,count;
 
     if( graph_getNodeCount( graph ) > 0 ) {
         cliqueid = fmem_alloc_arr( sizeof( graph_index_t ), graph_getNodeCount( graph ) );
@@ -34,16 +36,18 @@ graph_index_t *postprocess_enumerate_cliques( graph_t *graph, graphstate_t *base
             cliqueid[i] = -1;
         }
 
-        /* enumerate cliques */
+        /* enumerate cliques, nodes before i are already labeled */
+        active = graph_getActive( graph );
+        count = graph_getActiveCount( graph );
         c_id = 0;
-        for( i=0; i>=0; i = graph_getNext( graph, i ) ) {
+        for( k=0; k<count; k++ ) {
+            i = active[k];
             if( cliqueid[i] < 0 ) {
                 cliqueid[i] = c_id;
-                for( j=0; j>=0; j = graph_getNext( graph, j ) ) {
-                    if( i != j ) {
-                        if( cliqueid[j] < 0 && graph_getValue( graph, i, j ) >= 0 ) {
-                            cliqueid[j] = c_id;
-                        }
+                for( l=k+1; l<count; l++ ) {
+                    j = active[l];
+                    if( cliqueid[j] < 0 && graph_getValue( graph, i, j ) >= 0 ) {
+                        cliqueid[j] = c_id;
                     }
                 }
                 c_id++;
@@ -0,0 +1,188 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+
+#include "debug.h"
+#include "graph.h"
+#include "fmem.h"
+#include "reorder.h"
+
+/* Positive neighbours in compressed rows */
+typedef struct reorder_adj_t {
+    graph_size_t    *start;     /* Neighbours of n are at start[n]..start[n+1]-1 */
+    graph_index_t   *nb;
+} reorder_adj_t;
+
+void reorder_buildAdj( const graph_t *graph, reorder_adj_t *adj );
+void reorder_sortByDegree( const reorder_adj_t *adj, graph_size_t nodes, graph_index_t *byDegree );
+
+void reorder_buildAdj( const graph_t *graph, reorder_adj_t *adj ) {
+    graph_size_t nodes = graph_getNodeCount( graph );
+    graph_size_t *fill;
+    graph_index_t i, j;
+
+    adj->start = fmem_alloc_arr( sizeof( graph_size_t ), nodes + 1 );
+    for( i = 0; i <= nodes; i++ ) {
+        adj->start[i] = 0;
+    }
+    for( i = 0; i < nodes; i++ ) {
+        for( j = i + 1; j < nodes; j++ ) {
+            if( graph_getValue( graph, i, j ) > 0 ) {
+                adj->start[i+1]++;
+                adj->start[j+1]++;
+            }
+        }
+    }
+    for( i = 0; i < nodes; i++ ) {
+        adj->start[i+1] += adj->start[i];
+    }
+
+    adj->nb = fmem_alloc_arr( sizeof( graph_index_t ), adj->start[nodes] + 1 );
+    fill = fmem_alloc_arr( sizeof( graph_size_t ), nodes + 1 );
+    for( i = 0; i < nodes; i++ ) {
+        fill[i] = adj->start[i];
+    }
+    for( i = 0; i < nodes; i++ ) {
+        for( j = i + 1; j < nodes; j++ ) {
+            if( graph_getValue( graph, i, j ) > 0 ) {
+                adj->nb[ fill[i]++ ] = j;
+                adj->nb[ fill[j]++ ] = i;
+            }
+        }
+    }
+    fmem_free( fill );
+}
+
+/* Counting sort of the nodes by degree, stable so ties keep index order */
+void reorder_sortByDegree( const reorder_adj_t *adj, graph_size_t nodes, graph_index_t *byDegree ) {
+    graph_size_t *count;
+    graph_index_t i;
+
+    count = fmem_alloc_arr( sizeof( graph_size_t ), nodes + 1 );
+    for( i = 0; i <= nodes; i++ ) {
+        count[i] = 0;
+    }
+    for( i = 0; i < nodes; i++ ) {
+        count[ adj->start[i+1] - adj->start[i] + 1 ]++;
+    }
+    for( i = 0; i < nodes; i++ ) {
+        count[i+1] += count[i];
+    }
+    for( i = 0; i < nodes; i++ ) {
+        byDegree[ count[ adj->start[i+1] - adj->start[i] ]++ ] = i;
+    }
+    fmem_free( count );
+}
+
+graph_t *reorder_graph( const graph_t *graph, graph_index_t *order ) {
+    graph_size_t nodes = graph_getNodeCount( graph );
+    graph_size_t *fill;
+    graph_index_t *byDegree, *position, *nb;
+    char *visited;
+    reorder_adj_t adj;
+    graph_size_t head, tail, k, first, s;
+    graph_index_t i, j, n;
+    graph_value_t val;
+    graph_t *result;
+
+    reorder_buildAdj( graph, &adj );
+
+    byDegree = fmem_alloc_arr( sizeof( graph_index_t ), nodes + 1 );
+    visited = fmem_alloc_arr( sizeof( char ), nodes + 1 );
+    for( i = 0; i < nodes; i++ ) {
+        visited[i] = 0;
+    }
+    reorder_sortByDegree( &adj, nodes, byDegree );
+
+    /* Sort every neighbour list by degree, by adding the nodes to the lists
+     * of their neighbours in order of degree
+     */
+    nb = fmem_alloc_arr( sizeof( graph_index_t ), adj.start[nodes] + 1 );
+    fill = fmem_alloc_arr( sizeof( graph_size_t ), nodes + 1 );
+    for( i = 0; i < nodes; i++ ) {
+        fill[i] = adj.start[i];
+    }
+    for( s = 0; s < nodes; s++ ) {
+        n = byDegree[s];
+        for( k = adj.start[n]; k < adj.start[n+1]; k++ ) {
+            nb[ fill[ adj.nb[k] ]++ ] = n;
+        }
+    }
+    fmem_free( adj.nb );
+    fmem_free( fill );
+    adj.nb = nb;
+
+    /* order is used as the queue */
+    tail = 0;
+    for( s = 0; s < nodes; s++ ) {
+        if( visited[ byDegree[s] ] ) {
+            continue;
+        }
+        head = tail;
+        visited[ byDegree[s] ] = 1;
+        order[tail++] = byDegree[s];
+        while( head < tail ) {
+            n = order[head++];
+            for( k = adj.start[n]; k < adj.start[n+1]; k++ ) {
+                if( !visited[ adj.nb[k] ] ) {
+                    visited[ adj.nb[k] ] = 1;
+                    order[tail++] = adj.nb[k];
+                }
+            }
+        }
+    }
+    ASSERT( tail == nodes );
+
+    position = fmem_alloc_arr( sizeof( graph_index_t ), nodes + 1 );
+    for( k = 0; k < nodes; k++ ) {
+        position[ order[k] ] = k;
+    }
+
+    /* All edges start as -1, so only the others are set */
+    result = graph_create( nodes );
+    for( i = 0; i < nodes; i++ ) {
+        first = position[i];
+        for( j = i + 1; j < nodes; j++ ) {
+            val = graph_getValue( graph, i, j );
+            if( val != -1 ) {
+                graph_setValue( result, first, position[j], val );
+            }
+        }
+    }
+
+    fmem_free( adj.start );
+    fmem_free( adj.nb );
+    fmem_free( byDegree );
+    fmem_free( visited );
+    fmem_free( position );
+    return result;
+}
+
+void reorder_restore( graph_index_t *values, const graph_index_t *order, graph_size_t nodes ) {
+    graph_index_t *tmp;
+    graph_size_t k;
+
+    tmp = fmem_alloc_arr( sizeof( graph_index_t ), nodes + 1 );
+    for( k = 0; k < nodes; k++ ) {
+        tmp[ order[k] ] = values[k];
+    }
+    for( k = 0; k < nodes; k++ ) {
+        values[k] = tmp[k];
+    }
+    fmem_free( tmp );
+}
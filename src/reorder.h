@@ -0,0 +1,42 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef REORDER_H
+#define REORDER_H
+
+#include "graph.h"
+
+/* Relabel the nodes so that nodes joined by positive edges, which are
+ * likely to end up in the same cluster, get nearby indices and so nearby
+ * rows of the edge array.
+ *
+ * The order is breadth first over the positive edges, Cuthill-McKee
+ * style: every component starts at a node of lowest positive degree, and
+ * neighbours are queued by increasing degree. Takes O(N^2) time.
+ *
+ * Returns a relabeled copy of graph, and fills order, of
+ * graph_getNodeCount( graph ) entries, with the old index of every new
+ * node.
+ */
+graph_t *reorder_graph( const graph_t *graph, graph_index_t *order );
+
+/* Move per-node values from new to old indices, for example the clique ids
+ * of the relabeled graph before showing them with the input graph.
+ */
+void reorder_restore( graph_index_t *values, const graph_index_t *order, graph_size_t nodes );
+
+#endif
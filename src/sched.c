@@ -37,6 +37,9 @@ sched_t *sched_create(  const sched_strategy_t *strategy,
     }
 
     sched->best = NULL;
+    sched->branching = 0;
+    sched->jobs = 0;
+    sched->bitnodes = 0;
 
     return sched;
 }
@@ -62,6 +65,7 @@ int sched_job_compare( sched_t *sched, void *joba, void *jobb ) {
 int sched_stepone(  sched_t *sched ) {
     void *job = (*sched->strategy->job_fetch)( sched );
     if( job != NULL ) {
+        sched->jobs++;
         (*sched->algorithm->calculate)( sched, job );
         return 1;
     }
@@ -97,3 +101,13 @@ void *sched_resetBest( sched_t *sched ) {
 void        sched_inc_limit_job( sched_t *sched, void *job ) {
     (*sched->algorithm->inc_limit_job)( sched, job );
 }
+
+void        sched_clear( sched_t *sched ) {
+    void *job;
+    while( ( job = (*sched->strategy->job_fetch)( sched ) ) != NULL ) {
+        sched_job_free( sched, job );
+    }
+    if( sched->best != NULL ) {
+        sched_job_free( sched, sched_resetBest( sched ) );
+    }
+}
@@ -18,6 +18,8 @@
 #ifndef SCHED_H
 #define SCHED_H
 
+#include "graph.h"
+
 typedef struct sched_t sched_t;
 
 typedef struct sched_strategy_t {
@@ -39,6 +41,8 @@ typedef struct sched_algorithm_t {
     /* TODO: Change interface to handle cost-objects as discussed? */
     int (*job_compare)( sched_t*, void *, void * );
     void (*inc_limit_job)( sched_t*, void * );
+    /* Cost model of the graphstates of the jobs */
+    const graph_model_t *model;
 } sched_algorithm_t;
 
 struct sched_t {
@@ -49,6 +53,15 @@ struct sched_t {
 
     /* Best solution, FIXME: move to algorithm, maybe */
     void *best;
+
+    /* Branching policy for the algorithm, see branch.h */
+    int branching;
+
+    /* Statistics: number of calculated jobs */
+    long jobs;
+
+    /* Statistics: search nodes of the bitset solver, 0 if not used */
+    long bitnodes;
 };
 
 
@@ -73,5 +86,8 @@ void *      sched_resetBest( sched_t *sched );
 
 void        sched_inc_limit_job( sched_t *sched, void *job );
 
+/* Free the queued jobs and the best one, to abandon a search */
+void        sched_clear( sched_t *sched );
+
 
 #endif
@@ -0,0 +1,330 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "debug.h"
+#include "graph.h"
+#include "sched.h"
+#include "solve.h"
+#include "graphfile.h"
+#include "outbuf.h"
+#include "fmem.h"
+#include "server.h"
+
+#ifndef SERVER_THREADS_DEFAULT
+#define SERVER_THREADS_DEFAULT 4
+#endif
+
+#define SERVER_THREADS_MAX 64
+
+/* Connections waiting to be accepted */
+#define SERVER_BACKLOG 64
+
+/* Seconds a client may take to send its request, from its arrival */
+#define SERVER_READ_TIMEOUT 10
+
+/* Initial size of the request buffers */
+#define SERVER_BUFFER ( 1L << 16 )
+
+/* Largest request, in bytes, and node count. The memory a request can take
+ * is bounded by these, so that no client can make an allocation fail.
+ */
+#ifndef SERVER_REQUEST_MAX
+#define SERVER_REQUEST_MAX ( 1L << 28 )
+#endif
+#ifndef SERVER_NODES_MAX
+#define SERVER_NODES_MAX 10000
+#endif
+
+/* Accepted connections, in order */
+typedef struct server_request_t {
+    int             fd;
+    double          arrival;
+    struct server_request_t *next;
+} server_request_t;
+
+typedef struct server_t {
+    const solve_t   *settings;
+    server_request_t *first, *last;
+    pthread_mutex_t lock;
+    pthread_cond_t  work;
+} server_t;
+
+/* A thread, with what it keeps between requests */
+typedef struct server_worker_t {
+    server_t        *server;
+    sched_t         *sched;
+    char            *buf;       /* Request, also the storage of binary graphs */
+    size_t          size;
+    graph_index_t   *cliqueid;
+    graph_size_t    nodes;      /* Room in cliqueid */
+} server_worker_t;
+
+static int server_threads = SERVER_THREADS_DEFAULT;
+
+int server_receive( server_worker_t *worker, int fd, double until, size_t *len );
+void server_handle( server_worker_t *worker, server_request_t *req );
+void *server_worker( void *arg );
+
+void server_setThreads( int threads ) {
+    ASSERT( threads > 0 );
+    server_threads = threads < SERVER_THREADS_MAX ? threads : SERVER_THREADS_MAX;
+}
+
+/* Read the request into the buffer of worker, growing it as needed. Each
+ * read waits at most until the time until, as from solve_now; after it only
+ * what has already arrived is read. Returns 0 on errors and timeouts, and
+ * -1 if the request is too large.
+ */
+int server_receive( server_worker_t *worker, int fd, double until, size_t *len ) {
+    struct timeval tv;
+    ssize_t got;
+    size_t size;
+    double left;
+    char *tmp;
+
+    *len = 0;
+    for(;;) {
+        if( *len == worker->size ) {
+            if( worker->size >= SERVER_REQUEST_MAX ) {
+                return -1;
+            }
+            size = worker->size * 2 < SERVER_REQUEST_MAX ? worker->size * 2 : SERVER_REQUEST_MAX;
+            tmp = fmem_alloc( size );
+            memcpy( tmp, worker->buf, *len );
+            fmem_free( worker->buf );
+            worker->buf = tmp;
+            worker->size = size;
+        }
+
+        left = until - solve_now();
+        if( left > 0 ) {
+            tv.tv_sec = (long)left;
+            tv.tv_usec = (long)( ( left - tv.tv_sec ) * 1e6 );
+            if( tv.tv_sec == 0 && tv.tv_usec == 0 ) {
+                tv.tv_usec = 1; /* A zero timeout would wait forever */
+            }
+            setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof( tv ) );
+        }
+        got = recv( fd, worker->buf + *len, worker->size - *len, left > 0 ? 0 : MSG_DONTWAIT );
+        if( got == 0 ) {
+            return 1;
+        }
+        if( got < 0 ) {
+            if( errno == EINTR ) {
+                continue;
+            }
+            return 0;
+        }
+        *len += got;
+    }
+}
+
+void server_handle( server_worker_t *worker, server_request_t *req ) {
+    outbuf_t *ob;
+    graph_t *graph;
+    graph_cost_t cost;
+    graph_index_t i;
+    double deadline = 0;
+    size_t len, skip;
+    char *end;
+    long limit;
+    int ret;
+
+    ob = outbuf_createFd( req->fd );
+    ret = server_receive( worker, req->fd, req->arrival + SERVER_READ_TIMEOUT, &len );
+    if( ret <= 0 ) {
+        outbuf_puts( ob, ret < 0 ? "error request too large\n" : "error can't read request\n" );
+        outbuf_free( ob );
+        return;
+    }
+
+    /* Optional time limit, moved out of the way so the graph is aligned */
+    if( len > 6 && strncmp( worker->buf, "limit ", 6 ) == 0 ) {
+        limit = strtol( worker->buf + 6, &end, 10 );
+        if( end == worker->buf + 6 || limit < 0 || ( *end != '\n' && *end != '\r' ) ) {
+            outbuf_puts( ob, "error bad limit\n" );
+            outbuf_free( ob );
+            return;
+        }
+        deadline = req->arrival + limit / 1000.0;
+        end = memchr( end, '\n', worker->buf + len - end );
+        skip = end != NULL ? (size_t)( end + 1 - worker->buf ) : len;
+        memmove( worker->buf, worker->buf + skip, len - skip );
+        len -= skip;
+    }
+
+    if( deadline > 0 && solve_now() > deadline ) {
+        outbuf_puts( ob, "timeout\n" );
+        outbuf_free( ob );
+        return;
+    }
+
+    graph = len > 0 ? graphfile_readmem( worker->buf, len ) : NULL;
+    if( graph == NULL ) {
+        outbuf_puts( ob, "error can't read graph\n" );
+        outbuf_free( ob );
+        return;
+    }
+
+    if( graph_getNodeCount( graph ) > worker->nodes ) {
+        fmem_free( worker->cliqueid );
+        worker->nodes = graph_getNodeCount( graph );
+        worker->cliqueid = fmem_alloc_arr( sizeof( graph_index_t ), worker->nodes + 1 );
+    }
+
+    cost = solve_graph( worker->sched, worker->server->settings, graph, deadline, worker->cliqueid );
+    if( cost == SOLVE_TOO_LARGE ) {
+        outbuf_puts( ob, "error graph too large for the sparse layout\n" );
+    } else if( cost < 0 ) {
+        outbuf_puts( ob, "timeout\n" );
+    } else {
+        outbuf_puts( ob, "cost " );
+        outbuf_putlong( ob, cost, 0 );
+        outbuf_putc( ob, '\n' );
+        for( i=0; i<graph_getNodeCount( graph ); i++ ) {
+            if( i > 0 ) {
+                outbuf_putc( ob, ' ' );
+            }
+            outbuf_putlong( ob, worker->cliqueid[i], 0 );
+        }
+        outbuf_putc( ob, '\n' );
+    }
+    outbuf_free( ob );
+    graph_free( graph );
+}
+
+void *server_worker( void *arg ) {
+    server_t *server = (server_t *)arg;
+    server_worker_t worker;
+    server_request_t *req;
+
+    worker.server = server;
+    worker.sched = solve_createSched( server->settings );
+    worker.size = SERVER_BUFFER;
+    worker.buf = fmem_alloc( worker.size );
+    worker.nodes = 0;
+    worker.cliqueid = NULL;
+
+    for(;;) {
+        pthread_mutex_lock( &server->lock );
+        while( server->first == NULL ) {
+            pthread_cond_wait( &server->work, &server->lock );
+        }
+        req = server->first;
+        server->first = req->next;
+        if( server->first == NULL ) {
+            server->last = NULL;
+        }
+        pthread_mutex_unlock( &server->lock );
+
+        server_handle( &worker, req );
+        close( req->fd );
+        fmem_free( req );
+    }
+    return NULL;
+}
+
+int server_run( const char *path, const solve_t *settings ) {
+    pthread_t thread;
+    struct sockaddr_un addr;
+    server_request_t *req;
+    server_t server;
+    int fd, conn, t, started;
+
+    if( strlen( path ) >= sizeof( addr.sun_path ) ) {
+        fprintf( stderr, "Socket path too long: %s\n", path );
+        return 0;
+    }
+    memset( &addr, 0, sizeof( addr ) );
+    addr.sun_family = AF_UNIX;
+    strcpy( addr.sun_path, path );
+
+    fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if( fd < 0 ) {
+        perror( "socket" );
+        return 0;
+    }
+    unlink( path );
+    if( bind( fd, (struct sockaddr *)&addr, sizeof( addr ) ) != 0 || listen( fd, SERVER_BACKLOG ) != 0 ) {
+        perror( path );
+        close( fd );
+        return 0;
+    }
+
+    graphfile_setMaxNodes( SERVER_NODES_MAX );
+
+    /* Clients closing early must not end the server */
+    signal( SIGPIPE, SIG_IGN );
+
+    server.settings = settings;
+    server.first = NULL;
+    server.last = NULL;
+    pthread_mutex_init( &server.lock, NULL );
+    pthread_cond_init( &server.work, NULL );
+
+    started = 0;
+    for( t = 0; t < server_threads; t++ ) {
+        if( pthread_create( &thread, NULL, server_worker, &server ) == 0 ) {
+            pthread_detach( thread );
+            started++;
+        }
+    }
+    if( started == 0 ) {
+        fprintf( stderr, "Can't start threads\n" );
+        close( fd );
+        unlink( path );
+        return 0;
+    }
+
+    for(;;) {
+        conn = accept( fd, NULL, NULL );
+        if( conn < 0 ) {
+            if( errno != EINTR && errno != ECONNABORTED ) {
+                perror( "accept" );
+            }
+            continue;
+        }
+
+        req = fmem_alloc( sizeof( server_request_t ) );
+        req->fd = conn;
+        req->arrival = solve_now();
+        req->next = NULL;
+
+        pthread_mutex_lock( &server.lock );
+        if( server.last != NULL ) {
+            server.last->next = req;
+        } else {
+            server.first = req;
+        }
+        server.last = req;
+        pthread_cond_signal( &server.work );
+        pthread_mutex_unlock( &server.lock );
+    }
+    return 1;
+}
@@ -0,0 +1,53 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "solve.h"
+
+/* A resident solver on a Unix socket.
+ *
+ * A request is a connection, on which the client sends a graph in the
+ * text, PACE or binary format, optionally preceded by a line
+ * "limit <milliseconds>", and then shuts down its writing side. The limit
+ * counts from when the connection is accepted, including the time queued.
+ * The reply is one of
+ *
+ *   cost <cost>
+ *   <cluster id of node 0> <cluster id of node 1> ...
+ *
+ *   timeout
+ *
+ *   error <message>
+ *
+ * Requests larger than SERVER_REQUEST_MAX bytes, or graphs with more than
+ * SERVER_NODES_MAX nodes, are answered with an error.
+ *
+ * For example: (echo "limit 500"; cat graph.txt) | nc -NU <socket>
+ */
+
+/* Number of threads solving requests */
+void server_setThreads( int threads );
+
+/* Serve requests on a socket at path, replacing a stale one, on a pool of
+ * threads, each keeping its scheduler and buffers between requests.
+ * Returns 0 if the socket can't be set up, and doesn't return otherwise.
+ */
+int server_run( const char *path, const solve_t *settings );
+
+#endif
@@ -0,0 +1,162 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <sys/time.h>
+#include "debug.h"
+#include "graph.h"
+#include "graphstate.h"
+#include "sched.h"
+#include "postprocess.h"
+#include "bitgraph.h"
+#include "reorder.h"
+#include "fmem.h"
+#include "solve.h"
+
+/* Scheduler steps between looks at the clock */
+#define SOLVE_CHECK_STEPS 256
+
+graph_cost_t solve_search( sched_t *sched, graph_t *graph, double deadline, graph_index_t *cliqueid );
+
+sched_t *solve_createSched( const solve_t *settings ) {
+    sched_t *sched = sched_create( settings->strategy, settings->algorithm );
+    sched->branching = settings->branching;
+    return sched;
+}
+
+double solve_now( void ) {
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+graph_cost_t solve_graph( sched_t *sched, const solve_t *settings, graph_t *graph, double deadline, graph_index_t *cliqueid ) {
+    graph_t *copy;
+    graph_index_t *order;
+    graph_cost_t cost;
+
+    sched->jobs = 0;
+    sched->bitnodes = 0;
+
+    if( graph_getLayout( graph ) == GRAPH_LAYOUT_SPARSE && graph_getNodeCount( graph ) > SOLVE_SPARSE_NODES_MAX ) {
+        return SOLVE_TOO_LARGE;
+    }
+
+    /* Small graphs, like camera frames, are solved directly on bitsets */
+    if( settings->use_bitgraph && graph_getNodeCount( graph ) <= BITGRAPH_MAX_NODES ) {
+        return bitgraph_solve( graph, settings->algorithm->model, deadline, cliqueid, &sched->bitnodes );
+    }
+
+    if( !settings->reorder ) {
+        return solve_search( sched, graph, deadline, cliqueid );
+    }
+
+    /* Solve a relabeled copy, and give the cliques the input labels */
+    order = fmem_alloc_arr( sizeof( graph_index_t ), graph_getNodeCount( graph ) + 1 );
+    copy = reorder_graph( graph, order );
+    cost = solve_search( sched, copy, deadline, cliqueid );
+    if( cost >= 0 ) {
+        reorder_restore( cliqueid, order, graph_getNodeCount( graph ) );
+    }
+    graph_free( copy );
+    fmem_free( order );
+    return cost;
+}
+
+graph_cost_t solve_search( sched_t *sched, graph_t *graph, double deadline, graph_index_t *cliqueid ) {
+    graphstate_t *initstate;
+    graphstate_t *beststate;
+    graph_index_t *ids;
+    graph_index_t i;
+    graph_cost_t cost;
+    long steps = 0;
+#if DEBUG
+    long iterationcount;
+#endif
+
+    if( graph_getNodeCount( graph ) == 0 ) {
+        return 0;
+    }
+
+    /* First reference is treated as local reference */
+    initstate = graphstate_create_base( graph, 0 );
+
+#if DEBUG
+    iterationcount = 0;
+#endif
+    for(;;) {
+        DBGPRINT( 10, "-------------- Incrementing k-limit" );
+        /* Create a reference for job queue */
+        graphstate_incref( initstate );
+        sched_job_add( sched, initstate );
+        DBGLONG( 10, initstate->cost_left );
+        while( sched_stepone( sched ) ) {
+            DBGPRINT( 15, "step done" );
+#if DEBUG
+            iterationcount++;
+#endif
+            if( deadline > 0 && ++steps % SOLVE_CHECK_STEPS == 0 && solve_now() > deadline ) {
+                /* Give up, and return the graph to the input state */
+                sched_clear( sched );
+                graphstate_lock( initstate, sched->algorithm->model );
+                graphstate_unlock( initstate );
+                graphstate_decref( initstate );
+                return -1;
+            }
+        }
+        DBGLONG( 10, iterationcount );
+
+        beststate = sched_getBest( sched );
+        if( beststate == NULL ) {
+            graphstate_lock( initstate, sched->algorithm->model ); /* basecase: already got a cost */
+            sched_inc_limit_job( sched, initstate );
+            graphstate_unlock( initstate );
+        } else {
+            /* We found something */
+            break;
+        }
+    }
+    DBGLONG( 5, iterationcount );
+
+    beststate = sched_resetBest( sched );
+
+    DBGINT( 5, beststate->type );
+    /* node already visited through algorithm: already got a cost */
+    graphstate_lock( beststate, sched->algorithm->model );
+
+    /* same graph everywhare, therefore accessed through graph */
+    DBGLONG( 1, beststate->cost );
+    cost = beststate->cost;
+
+    ids = postprocess_enumerate_cliques( graph, initstate );
+    for( i=0; i<graph_getNodeCount( graph ); i++ ) {
+        cliqueid[i] = ids[i];
+    }
+    fmem_free( ids );
+
+    /* Return the graph to the input state */
+    graphstate_lock( initstate, sched->algorithm->model );
+    graphstate_unlock( initstate );
+
+    graphstate_unlock( beststate );
+    graphstate_decref( beststate );
+
+    /*remove local reference to initstate*/
+    graphstate_decref( initstate );
+
+    return cost;
+}
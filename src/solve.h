@@ -0,0 +1,69 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLVE_H
+#define SOLVE_H
+
+#include "graph.h"
+#include "sched.h"
+
+/* Largest graph in the sparse layout solve_graph takes on. The layout
+ * keeps the graph itself in memory proportional to the edges, but the
+ * kernel heaps, pair sums and triple index take some 40 bytes for every
+ * pair of nodes, 340 MB at this size. Solving in memory proportional to
+ * the edges, say 100000 nodes of low degree, would need all of these
+ * tables to be sparse too, which they are not.
+ */
+#ifndef SOLVE_SPARSE_NODES_MAX
+#define SOLVE_SPARSE_NODES_MAX 4096
+#endif
+
+/* Returned by solve_graph for graphs it doesn't take on */
+#define SOLVE_TOO_LARGE (-2)
+
+/* How instances are solved */
+typedef struct solve_t {
+    const sched_strategy_t  *strategy;
+    const sched_algorithm_t *algorithm;
+    int                     branching;
+    int                     use_bitgraph;   /* Bitset solver for small graphs */
+    int                     reorder;        /* Solve a relabeled copy */
+} solve_t;
+
+/* Scheduler for solve_graph, free with sched_free */
+sched_t *solve_createSched( const solve_t *settings );
+
+/* Seconds since the epoch, for deadlines */
+double solve_now( void );
+
+/* Solve graph with sched, raising the k-limit until a solution is found,
+ * and store the clique of every node in cliqueid, which has room for
+ * graph_getNodeCount( graph ) + 1 ids. Graphs of at most BITGRAPH_MAX_NODES
+ * nodes are solved on bitsets if use_bitgraph is set, whatever the
+ * algorithm, with the cost in the model of the algorithm. With reorder a
+ * relabeled copy is solved, see reorder.h. The graph is left in its input
+ * state. Returns the cost, or -1 if the search is still running at the
+ * deadline, as from solve_now. A deadline of 0 is none. Graphs in the
+ * sparse layout of more than SOLVE_SPARSE_NODES_MAX nodes are refused with
+ * SOLVE_TOO_LARGE, without touching cliqueid.
+ *
+ * Nothing is shared between calls with different schedulers and graphs,
+ * so instances can be solved on separate threads.
+ */
+graph_cost_t solve_graph( sched_t *sched, const solve_t *settings, graph_t *graph, double deadline, graph_index_t *cliqueid );
+
+#endif
@@ -0,0 +1,152 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "graph.h"
+#include "graphfile.h"
+#include "gen.h"
+#include "fmem.h"
+
+/* Writes graphs of every layout and width as binary files, and checks
+ * that they read back the same, from a stream and from a mapping, and
+ * that edits to a mapped graph stay out of the file
+ */
+
+#define BINARY_NODES 40
+
+int binary_compare( const graph_t *a, const graph_t *b, const char *what );
+int binary_check( graph_t *graph, const char *filename, const char *what );
+
+
+/* Returns 1 if the graphs differ */
+int binary_compare( const graph_t *a, const graph_t *b, const char *what ) {
+    graph_index_t i, j;
+
+    if( b == NULL ) {
+        fprintf( stderr, "%s: not read\n", what );
+        return 1;
+    }
+    if( graph_getNodeCount( a ) != graph_getNodeCount( b ) ||
+            graph_getLayout( a ) != graph_getLayout( b ) || graph_getWidth( a ) != graph_getWidth( b ) ) {
+        fprintf( stderr, "%s: %ld nodes, layout %d, width %d read as %ld nodes, layout %d, width %d\n", what,
+                (long)graph_getNodeCount( a ), graph_getLayout( a ), graph_getWidth( a ),
+                (long)graph_getNodeCount( b ), graph_getLayout( b ), graph_getWidth( b ) );
+        return 1;
+    }
+    for( i=0; i<graph_getNodeCount( a ); i++ ) {
+        for( j=i+1; j<graph_getNodeCount( a ); j++ ) {
+            if( graph_getValue( a, i, j ) != graph_getValue( b, i, j ) ) {
+                fprintf( stderr, "%s: edge %ld,%ld of %ld read as %ld\n", what, i, j,
+                        graph_getValue( a, i, j ), graph_getValue( b, i, j ) );
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+int binary_check( graph_t *graph, const char *filename, const char *what ) {
+    graph_t *loaded;
+    FILE *fp;
+    int failed = 0;
+
+    if( !graphfile_writebinary( graph, filename ) ) {
+        fprintf( stderr, "%s: can't write %s\n", what, filename );
+        return 1;
+    }
+
+    fp = fopen( filename, "rb" );
+    if( fp == NULL ) {
+        fprintf( stderr, "%s: can't read %s\n", what, filename );
+        return 1;
+    }
+    loaded = graphfile_readfobj( fp );
+    fclose( fp );
+    failed += binary_compare( graph, loaded, what );
+    graph_free( loaded );
+
+    /* Values past the width of the file are moved to memory */
+    loaded = graphfile_readfile( filename );
+    failed += binary_compare( graph, loaded, what );
+    if( loaded != NULL ) {
+        graph_setValue( loaded, 0, 1, 1000 );
+        graph_setValue( loaded, 1, 2, GRAPH_VALUE_FORBIDDEN );
+        if( graph_getValue( loaded, 0, 1 ) != 1000 || graph_getValue( loaded, 1, 2 ) != GRAPH_VALUE_FORBIDDEN ) {
+            fprintf( stderr, "%s: edits to the mapped graph lost\n", what );
+            failed++;
+        }
+        graph_free( loaded );
+    }
+
+    loaded = graphfile_readfile( filename );
+    failed += binary_compare( graph, loaded, what );
+    graph_free( loaded );
+
+    return failed;
+}
+
+int main( int argc, char *argv[] ) {
+    static const int widths[] = { 1, 2, 4, GRAPH_WIDTH_MAX };
+    graph_t *graph;
+    char *filename;
+    char what[64];
+    int layout, w, failed = 0;
+
+#if DEBUG
+    g_debug_level = 0;
+#endif
+
+    filename = fmem_alloc( strlen( argv[0] ) + 5 );
+    sprintf( filename, "%s.tmp", argv[0] );
+
+    for( layout=GRAPH_LAYOUT_TRIANGULAR; layout<=GRAPH_LAYOUT_SQUARE; layout++ ) {
+        for( w=0; w<4; w++ ) {
+            graph_setDefaultLayout( layout );
+            graph_setDefaultWidth( widths[w] );
+            srand( w + 1 );
+            graph = gen_generate( BINARY_NODES, 5, 20, 5 );
+            graph_setValue( graph, 3, 4, 0 );
+            graph_setValue( graph, 5, 6, GRAPH_VALUE_FORBIDDEN );
+            graph_setValue( graph, 7, 8, GRAPH_VALUE_PERSISTANT );
+            if( widths[w] > 1 ) {
+                graph_setValue( graph, 9, 10, -300 );
+            }
+
+            sprintf( what, "%s/%d", layout == GRAPH_LAYOUT_SQUARE ? "square" : "triangular", widths[w] );
+            failed += binary_check( graph, filename, what );
+            graph_free( graph );
+        }
+    }
+
+    /* Sparse graphs have no binary form */
+    graph_setDefaultLayout( GRAPH_LAYOUT_SPARSE );
+    graph = graph_create( BINARY_NODES );
+    if( graphfile_writebinary( graph, filename ) ) {
+        fprintf( stderr, "sparse: written as binary\n" );
+        failed++;
+    }
+    graph_free( graph );
+
+    remove( filename );
+    fmem_free( filename );
+
+    printf( "%s: %s\n", argv[0], failed ? "FAILED" : "ok" );
+    return failed ? 1 : 0;
+}
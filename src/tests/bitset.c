@@ -0,0 +1,137 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "debug.h"
+#include "graph.h"
+#include "gen.h"
+#include "fmem.h"
+#include "sched.h"
+#include "solve.h"
+#include "branch.h"
+#include "validate.h"
+#include "bitgraph.h"
+#include "strategy_depth_first.h"
+#include "alg_2k.h"
+#include "alg_2_62k.h"
+#include "alg_3k.h"
+
+/* Solves small graphs with the bitset solver and with the search, as -x
+ * does, and checks that the costs agree. 3k isn't exhaustive, so it may
+ * only do worse than the bitset solver, and it leaves zero-edges that
+ * don't form a conflict with strict signs undecided, so its clusters may
+ * edit more than its cost.
+ */
+
+typedef struct bitset_alg_t {
+    const char          *name;
+    sched_algorithm_t   *alg;
+    int                 exact;
+} bitset_alg_t;
+
+static const bitset_alg_t bitset_algs[] = {
+    {"2k",      &alg_2k,    1},
+    {"2.62k",   &alg_2_62k, 1},
+    {"3k",      &alg_3k,    0},
+    {NULL, NULL, 0}
+};
+
+graph_cost_t bitset_solve( const graph_t *graph, const bitset_alg_t *alg, int use_bitgraph, graph_index_t *cliqueid );
+int bitset_check( graph_t *graph, const bitset_alg_t *alg, const char *what );
+
+
+graph_cost_t bitset_solve( const graph_t *graph, const bitset_alg_t *alg, int use_bitgraph, graph_index_t *cliqueid ) {
+    solve_t settings;
+    sched_t *sched;
+    graph_cost_t cost;
+
+    settings.strategy = &strategy_depthFirst;
+    settings.algorithm = alg->alg;
+    settings.branching = BRANCH_FIRST;
+    settings.use_bitgraph = use_bitgraph;
+    settings.reorder = 0;
+
+    sched = solve_createSched( &settings );
+    cost = solve_graph( sched, &settings, (graph_t *)graph, 0, cliqueid );
+    sched_free( sched );
+    return cost;
+}
+
+/* Costs in the (1,0) model are the edits of the clusters, for the exact
+ * algorithms
+ */
+int bitset_check( graph_t *graph, const bitset_alg_t *alg, const char *what ) {
+    graph_index_t *cliqueid;
+    graph_cost_t bits, search;
+    validate_t *result;
+    int use_bitgraph, failed = 0;
+
+    cliqueid = fmem_alloc_arr( sizeof( graph_index_t ), graph_getNodeCount( graph ) + 1 );
+    bits = search = 0;
+    for( use_bitgraph=1; use_bitgraph>=0; use_bitgraph-- ) {
+        if( use_bitgraph ) {
+            bits = bitset_solve( graph, alg, 1, cliqueid );
+        } else {
+            search = bitset_solve( graph, alg, 0, cliqueid );
+        }
+        if( alg->alg->model == &graph_model_1_0 && ( use_bitgraph || alg->exact ) ) {
+            result = validate_solution( graph, cliqueid );
+            if( result->cost != ( use_bitgraph ? bits : search ) ) {
+                fprintf( stderr, "%s, %s%s: cost %ld, clusters edit %ld\n", what, alg->name,
+                        use_bitgraph ? "" : " -x", use_bitgraph ? bits : search, result->cost );
+                failed++;
+            }
+            validate_free( result );
+        }
+    }
+
+    if( alg->exact ? search != bits : search < bits ) {
+        fprintf( stderr, "%s, %s: cost %ld, %ld with -x\n", what, alg->name, bits, search );
+        failed++;
+    }
+    fmem_free( cliqueid );
+    return failed;
+}
+
+int main( int argc, char *argv[] ) {
+    graph_t *graph;
+    char what[64];
+    int seed, nodes, weight, i, failed = 0;
+
+#if DEBUG
+    g_debug_level = 0;
+#endif
+
+    for( seed=1; seed<=5; seed++ ) {
+        for( nodes=4; nodes<=24; nodes+=4 ) {
+            /* Weight 1 makes the noise zero-edges */
+            for( weight=1; weight<=5; weight+=4 ) {
+                srand( seed );
+                graph = gen_generate( nodes, nodes / 4 + 1, nodes / 2, weight );
+                sprintf( what, "seed %d, %d nodes, weight %d", seed, nodes, weight );
+                for( i=0; bitset_algs[i].name != NULL; i++ ) {
+                    failed += bitset_check( graph, &bitset_algs[i], what );
+                }
+                graph_free( graph );
+            }
+        }
+    }
+
+    printf( "%s: %s\n", argv[0], failed ? "FAILED" : "ok" );
+    return failed ? 1 : 0;
+}
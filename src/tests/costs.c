@@ -0,0 +1,117 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "debug.h"
+#include "graph.h"
+#include "gen.h"
+#include "fmem.h"
+#include "sched.h"
+#include "solve.h"
+#include "branch.h"
+#include "validate.h"
+#include "strategy_depth_first.h"
+#include "alg_2_62k.h"
+#include "alg_3k.h"
+
+/* Pins the costs reported by 3k on graphs too large for the bitset
+ * solver. 3k runs its kernel and its search in the (1,0) model, so its
+ * cost is the editing cost of its clusters, and on these graphs the same
+ * as that of 2.62k. With the kernel in the (2,1) model the cost was in
+ * mixed units, twice the edits on these graphs.
+ */
+
+typedef struct costs_case_t {
+    int             nodes, cliques, noise, weight;
+    int             seed;
+    graph_cost_t    cost;
+} costs_case_t;
+
+static const costs_case_t costs_cases[] = {
+    { 80,  8, 30, 3, 1, 30},
+    { 80,  8, 30, 3, 2, 30},
+    {100, 10, 30, 3, 1, 30},
+    {150, 15, 30, 3, 1, 30},
+    { 60,  6, 15, 5, 1, 30},
+    { 60,  6, 15, 5, 2, 30},
+    {0, 0, 0, 0, 0, 0}
+};
+
+graph_cost_t costs_solve( graph_t *graph, sched_algorithm_t *alg, graph_index_t *cliqueid );
+int costs_check( const costs_case_t *c );
+
+
+graph_cost_t costs_solve( graph_t *graph, sched_algorithm_t *alg, graph_index_t *cliqueid ) {
+    solve_t settings;
+    sched_t *sched;
+    graph_cost_t cost;
+
+    settings.strategy = &strategy_depthFirst;
+    settings.algorithm = alg;
+    settings.branching = BRANCH_FIRST;
+    settings.use_bitgraph = 0;
+    settings.reorder = 0;
+
+    sched = solve_createSched( &settings );
+    cost = solve_graph( sched, &settings, graph, 0, cliqueid );
+    sched_free( sched );
+    return cost;
+}
+
+/* Returns 1 if a cost differs from the pinned one */
+int costs_check( const costs_case_t *c ) {
+    graph_t *graph;
+    graph_index_t *cliqueid;
+    graph_cost_t cost3k, cost262k;
+    validate_t *result;
+    int failed = 0;
+
+    srand( c->seed );
+    graph = gen_generate( c->nodes, c->cliques, c->noise, c->weight );
+    cliqueid = fmem_alloc_arr( sizeof( graph_index_t ), c->nodes + 1 );
+
+    cost262k = costs_solve( graph, &alg_2_62k, cliqueid );
+    cost3k = costs_solve( graph, &alg_3k, cliqueid );
+    result = validate_solution( graph, cliqueid );
+    if( cost3k != c->cost || cost262k != c->cost || result->cost != cost3k ) {
+        fprintf( stderr, "%d:%d:%d:%d seed %d: 3k %ld, 2.62k %ld, clusters edit %ld, expected %ld\n",
+                c->nodes, c->cliques, c->noise, c->weight, c->seed,
+                cost3k, cost262k, result->cost, c->cost );
+        failed++;
+    }
+
+    validate_free( result );
+    fmem_free( cliqueid );
+    graph_free( graph );
+    return failed;
+}
+
+int main( int argc, char *argv[] ) {
+    int i, failed = 0;
+
+#if DEBUG
+    g_debug_level = 0;
+#endif
+
+    for( i=0; costs_cases[i].nodes > 0; i++ ) {
+        failed += costs_check( &costs_cases[i] );
+    }
+
+    printf( "%s: %s\n", argv[0], failed ? "FAILED" : "ok" );
+    return failed ? 1 : 0;
+}
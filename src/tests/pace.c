@@ -0,0 +1,204 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "graph.h"
+#include "pacefile.h"
+#include "fmem.h"
+
+/* Reads PACE files with the block boundary of the stream reader moved
+ * through the lines, and checks the edges kept from bad input
+ */
+
+/* Bytes read at a time by pacefile_readfobj */
+#define PACE_BLOCK ( 1L << 16 )
+
+/* Offsets of the block boundary tried, from the start of the "p" line */
+#define PACE_OFFSETS 48
+
+#define PACE_NODES 12
+
+typedef struct pace_case_t {
+    const char  *input;
+    long        nodes;      /* -1 if no graph */
+    const char  *edges;     /* Node pairs read as edges, 1-based */
+} pace_case_t;
+
+static const pace_case_t pace_cases[] = {
+    { "",                                       -1, "" },
+    { "c no problem line\n",                    -1, "" },
+    { "1 2\np cep 3 1\n",                       3,  "" },
+    { "p cep 3\n1 2\n",                         -1, "" },
+    { "p cxp 3 1\n1 2\n",                       -1, "" },
+    { "p cep 3 -1\n",                           -1, "" },
+    { "p cep 99999999999 0\n",                  -1, "" },
+    { "p cep 3 2\n1 2\n1 x\n2 3\n",             3,  "1 2 2 3" },
+    { "p cep 3 2\n1 4\n0 1\n2 2\n1 3\n",        3,  "1 3" },
+    { "p cep 3 1\n1 2 3\n2 3\n",                3,  "2 3" },
+    { "p cep 3 1\n1 99999999999999999999999\n2 3\n", 3, "2 3" },
+    { "p cep 3 1\np cep 4 1\n1 2\n",            3,  "1 2" },
+    { "c x\r\n\r\np  cep\t3 1 \r\n 1\t3\r\n",   3,  "1 3" },
+    { "p cep 2 1\n1 2",                         2,  "1 2" },
+    { NULL, 0, NULL }
+};
+
+int pace_edges( const graph_t *graph, const char *edges, const char *what );
+int pace_split( const char *filename, const char *eol );
+int pace_bad( void );
+
+
+/* Returns 1 unless the edges are those listed, and the rest non-edges */
+int pace_edges( const graph_t *graph, const char *edges, const char *what ) {
+    graph_index_t i, j;
+    graph_value_t *expect;
+    graph_size_t nodes = graph_getNodeCount( graph );
+    const char *p = edges;
+    char *end;
+    int failed = 0;
+
+    expect = fmem_alloc_arr( sizeof( graph_value_t ), nodes * nodes );
+    for( i=0; i<nodes*nodes; i++ ) {
+        expect[i] = -1;
+    }
+    for( ;; ) {
+        i = strtol( p, &end, 10 );
+        if( end == p ) {
+            break;
+        }
+        j = strtol( end, &end, 10 );
+        p = end;
+        expect[(i-1)*nodes + j-1] = expect[(j-1)*nodes + i-1] = 1;
+    }
+
+    for( i=0; i<nodes && !failed; i++ ) {
+        for( j=i+1; j<nodes; j++ ) {
+            if( graph_getValue( graph, i, j ) != expect[i*nodes + j] ) {
+                fprintf( stderr, "%s: edge %ld,%ld read as %ld\n", what, i + 1, j + 1, graph_getValue( graph, i, j ) );
+                failed = 1;
+                break;
+            }
+        }
+    }
+    fmem_free( expect );
+    return failed;
+}
+
+/* The same file, with the block boundary at each offset of the first lines */
+int pace_split( const char *filename, const char *eol ) {
+    char edges[8*PACE_NODES*PACE_NODES];
+    char what[64];
+    graph_t *graph;
+    FILE *fp;
+    long offset, pad;
+    int i, j, count, failed = 0;
+
+    edges[0] = '\0';
+    count = 0;
+    for( i=1; i<=PACE_NODES; i++ ) {
+        for( j=i+1; j<=PACE_NODES; j++ ) {
+            if( ( i * 7 + j * 3 ) % 5 < 2 ) {
+                sprintf( edges + strlen( edges ), "%d %d ", i, j );
+                count++;
+            }
+        }
+    }
+
+    for( offset=0; offset<PACE_OFFSETS; offset++ ) {
+        fp = fopen( filename, "wb" );
+        if( fp == NULL ) {
+            fprintf( stderr, "Can't write %s\n", filename );
+            return 1;
+        }
+
+        /* A comment filling the first block up to the offset */
+        fputc( 'c', fp );
+        for( pad=1+strlen( eol ); pad<PACE_BLOCK-offset; pad++ ) {
+            fputc( 'x', fp );
+        }
+        fprintf( fp, "%sp cep %d %d%s", eol, PACE_NODES, count, eol );
+        for( i=1; i<=PACE_NODES; i++ ) {
+            for( j=i+1; j<=PACE_NODES; j++ ) {
+                if( ( i * 7 + j * 3 ) % 5 < 2 ) {
+                    fprintf( fp, "%d %d%s", i, j, eol );
+                }
+            }
+        }
+        fclose( fp );
+
+        fp = fopen( filename, "rb" );
+        graph = pacefile_readfobj( fp );
+        fclose( fp );
+
+        sprintf( what, "split at %ld%s", offset, eol[0] == '\r' ? ", CRLF" : "" );
+        if( graph == NULL || graph_getNodeCount( graph ) != PACE_NODES ) {
+            fprintf( stderr, "%s: not read\n", what );
+            failed++;
+        } else {
+            failed += pace_edges( graph, edges, what );
+        }
+        graph_free( graph );
+    }
+    return failed;
+}
+
+/* Bad lines are reported and skipped, a bad "p" line gives no graph */
+int pace_bad( void ) {
+    graph_t *graph;
+    char what[32];
+    int k, failed = 0;
+
+    for( k=0; pace_cases[k].input != NULL; k++ ) {
+        sprintf( what, "case %d", k + 1 );
+        graph = pacefile_readmem( pace_cases[k].input, strlen( pace_cases[k].input ) );
+        if( graph == NULL ? pace_cases[k].nodes >= 0 : graph_getNodeCount( graph ) != pace_cases[k].nodes ) {
+            fprintf( stderr, "%s: %ld nodes read, expected %ld\n", what,
+                    graph == NULL ? -1L : (long)graph_getNodeCount( graph ), pace_cases[k].nodes );
+            failed++;
+        } else if( graph != NULL ) {
+            failed += pace_edges( graph, pace_cases[k].edges, what );
+        }
+        if( graph != NULL ) {
+            graph_free( graph );
+        }
+    }
+    return failed;
+}
+
+int main( int argc, char *argv[] ) {
+    char *filename;
+    int failed = 0;
+
+#if DEBUG
+    g_debug_level = 0;
+#endif
+
+    filename = fmem_alloc( strlen( argv[0] ) + 5 );
+    sprintf( filename, "%s.tmp", argv[0] );
+
+    failed += pace_split( filename, "\n" );
+    failed += pace_split( filename, "\r\n" );
+    remove( filename );
+    fmem_free( filename );
+
+    failed += pace_bad();
+
+    printf( "%s: %s\n", argv[0], failed ? "FAILED" : "ok" );
+    return failed ? 1 : 0;
+}
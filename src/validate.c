@@ -0,0 +1,180 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "debug.h"
+#include "graph.h"
+#include "fmem.h"
+#include "validate.h"
+
+#ifndef VALIDATE_THREADS_DEFAULT
+#define VALIDATE_THREADS_DEFAULT 4
+#endif
+
+#define VALIDATE_THREADS_MAX 64
+
+/* Graphs with fewer pairs are not worth starting threads for */
+#define VALIDATE_PAIRS_PER_THREAD 65536
+
+/* Rows first to last-1 of the active nodes in index order */
+typedef struct validate_part_t {
+    const graph_t       *graph;
+    const graph_index_t *cliqueid;
+    const graph_index_t *nodes;
+    graph_size_t        count;
+    graph_size_t        first, last;
+
+    graph_cost_t        cost;
+    graph_size_t        edits;
+    graph_size_t        size;
+    validate_edit_t     *edit;
+} validate_part_t;
+
+static int validate_threads = VALIDATE_THREADS_DEFAULT;
+
+void validate_addEdit( validate_part_t *part, graph_index_t a, graph_index_t b, graph_value_t value );
+void *validate_rows( void *arg );
+
+void validate_setThreads( int threads ) {
+    ASSERT( threads > 0 );
+    validate_threads = threads < VALIDATE_THREADS_MAX ? threads : VALIDATE_THREADS_MAX;
+}
+
+void validate_addEdit( validate_part_t *part, graph_index_t a, graph_index_t b, graph_value_t value ) {
+    validate_edit_t *edit;
+
+    if( part->edits == part->size ) {
+        part->size = part->size ? part->size * 2 : 64;
+        edit = fmem_alloc_arr( sizeof( validate_edit_t ), part->size );
+        if( part->edits > 0 ) {
+            memcpy( edit, part->edit, sizeof( validate_edit_t ) * part->edits );
+        }
+        fmem_free( part->edit );
+        part->edit = edit;
+    }
+    edit = &part->edit[part->edits++];
+    edit->a = a;
+    edit->b = b;
+    edit->value = value;
+}
+
+void *validate_rows( void *arg ) {
+    validate_part_t *part = (validate_part_t *)arg;
+    graph_index_t a, b;
+    graph_size_t i, j;
+    graph_value_t val;
+
+    for( i = part->first; i < part->last; i++ ) {
+        a = part->nodes[i];
+        for( j = i + 1; j < part->count; j++ ) {
+            b = part->nodes[j];
+            val = graph_getValue( part->graph, a, b );
+            if( part->cliqueid[a] == part->cliqueid[b] ? val <= 0 : val >= 0 ) {
+                part->cost += val < 0 ? -val : val;
+                validate_addEdit( part, a, b, val );
+            }
+        }
+    }
+    return NULL;
+}
+
+validate_t *validate_solution( const graph_t *graph, const graph_index_t *cliqueid ) {
+    validate_part_t part[VALIDATE_THREADS_MAX];
+    pthread_t thread[VALIDATE_THREADS_MAX];
+    int started[VALIDATE_THREADS_MAX];
+    graph_index_t *nodes;
+    graph_size_t count, pairs, done, row;
+    validate_t *result;
+    int t, threads;
+
+    /* Rows in index order, as the active nodes are, so the edits of the
+     * parts end up sorted
+     */
+    count = graph_getActiveCount( graph );
+    nodes = fmem_alloc_arr( sizeof( graph_index_t ), count + 1 );
+    if( count > 0 ) {
+        memcpy( nodes, graph_getActive( graph ), sizeof( graph_index_t ) * count );
+    }
+
+    pairs = count * ( count - 1 ) / 2;
+    threads = validate_threads;
+    while( threads > 1 && pairs / threads < VALIDATE_PAIRS_PER_THREAD ) {
+        threads--;
+    }
+
+    /* Split the triangle into parts of about the same number of pairs */
+    row = 0;
+    done = 0;
+    for( t = 0; t < threads; t++ ) {
+        part[t].graph = graph;
+        part[t].cliqueid = cliqueid;
+        part[t].nodes = nodes;
+        part[t].count = count;
+        part[t].first = row;
+        while( row < count && ( t == threads - 1 || done < pairs / threads * ( t + 1 ) ) ) {
+            done += count - row - 1;
+            row++;
+        }
+        part[t].last = row;
+        part[t].cost = 0;
+        part[t].edits = 0;
+        part[t].size = 0;
+        part[t].edit = NULL;
+    }
+
+    for( t = 1; t < threads; t++ ) {
+        started[t] = pthread_create( &thread[t], NULL, validate_rows, &part[t] ) == 0;
+        if( !started[t] ) {
+            /* Do it in this thread instead */
+            validate_rows( &part[t] );
+        }
+    }
+    validate_rows( &part[0] );
+    for( t = 1; t < threads; t++ ) {
+        if( started[t] ) {
+            pthread_join( thread[t], NULL );
+        }
+    }
+
+    result = fmem_alloc( sizeof( validate_t ) );
+    result->cost = 0;
+    result->count = 0;
+    for( t = 0; t < threads; t++ ) {
+        result->cost += part[t].cost;
+        result->count += part[t].edits;
+    }
+    result->edits = fmem_alloc_arr( sizeof( validate_edit_t ), result->count + 1 );
+    done = 0;
+    for( t = 0; t < threads; t++ ) {
+        if( part[t].edits > 0 ) {
+            memcpy( result->edits + done, part[t].edit, sizeof( validate_edit_t ) * part[t].edits );
+            done += part[t].edits;
+        }
+        fmem_free( part[t].edit );
+    }
+
+    fmem_free( nodes );
+    return result;
+}
+
+void validate_free( validate_t *result ) {
+    fmem_free( result->edits );
+    fmem_free( result );
+}
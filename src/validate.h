@@ -0,0 +1,49 @@
+/*
+ * This file is part of cluster-editing-algorithms
+ *
+ * cluster-editing-algorithms is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cluster-editing-algorithms is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cluster-editing-algorithms.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef VALIDATE_H
+#define VALIDATE_H
+
+#include "graph.h"
+
+/* A pair whose edge disagrees with the clustering, a < b */
+typedef struct validate_edit_t {
+    graph_index_t   a, b;
+    graph_value_t   value;
+} validate_edit_t;
+
+typedef struct validate_t {
+    graph_cost_t    cost;   /* Sum of |value| over the edits */
+    graph_size_t    count;
+    validate_edit_t *edits; /* Ordered by a, then b */
+} validate_t;
+
+/* Number of threads used by validate_solution */
+void validate_setThreads( int threads );
+
+/* Compare the clustering in cliqueid, as from postprocess_enumerate_cliques,
+ * to the edges between the active nodes of graph, in one pass over the
+ * pairs. Positive edges between cliques and negative edges within a clique
+ * are edits. Zero-edges are listed as well, but cost nothing.
+ *
+ * Rows are split between threads.
+ */
+validate_t *validate_solution( const graph_t *graph, const graph_index_t *cliqueid );
+
+void validate_free( validate_t *result );
+
+#endif
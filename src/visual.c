@@ -20,49 +20,272 @@
 #include "graph.h"
 #include "graphstate.h"
 #include "visual.h"
+#include "validate.h"
+#include "outbuf.h"
 #include "fmem.h"
 
+static int visual_format = VISUAL_FORMAT_TEXT;
+static int visual_header = 0; /* CSV header of named instances written */
+
+void visual_text( outbuf_t *ob, graph_t *graph, graph_index_t *cliqueid, validate_t *result );
+void visual_csv( outbuf_t *ob, graph_t *graph, graph_index_t *cliqueid, const char *name );
+void visual_edits( outbuf_t *ob, validate_t *result, const char *name );
+void visual_csvHeader( outbuf_t *ob, const char *columns, const char *name );
+void visual_csvString( outbuf_t *ob, const char *str );
+void visual_json( outbuf_t *ob, graph_t *graph, graph_index_t *cliqueid, validate_t *result, const char *name );
+void visual_jsonString( outbuf_t *ob, const char *str );
+
+void visual_setFormat( int format ) {
+    ASSERT( format >= 0 && format < VISUAL_FORMATS );
+    visual_format = format;
+}
+
+int visual_getFormat( void ) {
+    return visual_format;
+}
+
 void visual_show( graph_t *graph, graph_index_t *cliqueid ) {
+    visual_showInstance( graph, cliqueid, NULL );
+}
+
+void visual_showInstance( graph_t *graph, graph_index_t *cliqueid, const char *name ) {
+    outbuf_t *ob;
+    validate_t *result = NULL;
+
+    if( cliqueid != NULL && visual_format != VISUAL_FORMAT_CSV ) {
+        result = validate_solution( graph, cliqueid );
+    }
+
+    ob = outbuf_create( stdout );
+    if( name != NULL && visual_format == VISUAL_FORMAT_TEXT ) {
+        outbuf_puts( ob, "Instance: " );
+        outbuf_puts( ob, name );
+        outbuf_putc( ob, '\n' );
+    }
+    switch( visual_format ) {
+        case VISUAL_FORMAT_CSV:   visual_csv( ob, graph, cliqueid, name ); break;
+        case VISUAL_FORMAT_EDITS: visual_edits( ob, result, name ); break;
+        case VISUAL_FORMAT_JSON:  visual_json( ob, graph, cliqueid, result, name ); break;
+        default:
+            if( cliqueid == NULL ) {
+                outbuf_puts( ob, "Not solved\n" );
+            } else {
+                visual_text( ob, graph, cliqueid, result );
+            }
+            break;
+    }
+    outbuf_free( ob );
+
+    if( result != NULL ) {
+        validate_free( result );
+    }
+}
+
+void visual_text( outbuf_t *ob, graph_t *graph, graph_index_t *cliqueid, validate_t *result ) {
     graph_index_t i,j;
     graph_index_t c_id;
     graph_value_t val;
+    graph_size_t k, nodes;
+    graph_size_t *start;
+    graph_index_t *member;
+
+    nodes = graph_getNodeCount( graph );
     c_id = 0;
     /* Fetch maximum clique id */
-    for( i=graph_getNodeCount( graph )-1; i>=0; i-- ) {
+    for( i=nodes-1; i>=0; i-- ) {
         if( cliqueid[i]+1 > c_id ) {
             c_id = cliqueid[i]+1;
         }
     }
-    /* Print cliques */
+
+    /* Bucket the nodes by clique, in order */
+    start = fmem_alloc_arr( sizeof( graph_size_t ), c_id + 1 );
+    member = fmem_alloc_arr( sizeof( graph_index_t ), nodes + 1 );
+    for( i=0; i<=c_id; i++ ) {
+        start[i] = 0;
+    }
+    for( j=0; j<nodes; j++ ) {
+        start[cliqueid[j]+1]++;
+    }
     for( i=0; i<c_id; i++ ) {
-        printf( "%4ld =", i );
-        for( j=0; j<graph_getNodeCount( graph ); j++ ) {
-            if( cliqueid[j] == i ) {
-                printf( " %3ld", j );
-            }
+        start[i+1] += start[i];
+    }
+    for( j=0; j<nodes; j++ ) {
+        member[start[cliqueid[j]]++] = j;
+    }
+
+    /* Print cliques, start[i] is now the end of clique i */
+    for( i=0, k=0; i<c_id; i++ ) {
+        outbuf_putlong( ob, i, 4 );
+        outbuf_puts( ob, " =" );
+        for( ; k<start[i]; k++ ) {
+            outbuf_putc( ob, ' ' );
+            outbuf_putlong( ob, member[k], 3 );
         }
-        printf( "\n" );
+        outbuf_putc( ob, '\n' );
     }
+    fmem_free( start );
+    fmem_free( member );
 
     /* Print missmatches */
-    for( i=0; i>=0; i = graph_getNext( graph, i ) ) {
-        for( j=graph_getNext( graph, i ); j>=0; j = graph_getNext( graph, j ) ) {
-            if( i != j ) {
-                val = graph_getValue( graph, i, j );
-                if( val>0 && cliqueid[i]!=cliqueid[j] ) {
-                    printf( "Edge missmatch %ld and %ld, value: %ld\n", i, j, val );
-                }
-                if( val<0 && cliqueid[i]==cliqueid[j] ) {
-                    printf( "Nonedge missmatch %ld and %ld, value: %ld\n", i, j, val );
-                }
-                if( val==0 ) {
-                    if( cliqueid[i]==cliqueid[j] ) {
-                        printf( "Zeroedge treated as edge %ld and %ld\n", i, j );
-                    } else {
-                        printf( "Zeroedge treated as non-edge %ld and %ld\n", i, j );
-                    }
-                }
+    for( k=0; k<result->count; k++ ) {
+        i = result->edits[k].a;
+        j = result->edits[k].b;
+        val = result->edits[k].value;
+        if( val>0 ) {
+            outbuf_puts( ob, "Edge missmatch " );
+        } else if( val<0 ) {
+            outbuf_puts( ob, "Nonedge missmatch " );
+        } else if( cliqueid[i]==cliqueid[j] ) {
+            outbuf_puts( ob, "Zeroedge treated as edge " );
+        } else {
+            outbuf_puts( ob, "Zeroedge treated as non-edge " );
+        }
+        outbuf_putlong( ob, i, 0 );
+        outbuf_puts( ob, " and " );
+        outbuf_putlong( ob, j, 0 );
+        if( val != 0 ) {
+            outbuf_puts( ob, ", value: " );
+            outbuf_putlong( ob, val, 0 );
+        }
+        outbuf_putc( ob, '\n' );
+    }
+    outbuf_puts( ob, "Editing cost: " );
+    outbuf_putlong( ob, result->cost, 0 );
+    outbuf_putc( ob, '\n' );
+}
+
+void visual_csv( outbuf_t *ob, graph_t *graph, graph_index_t *cliqueid, const char *name ) {
+    graph_index_t i;
+
+    visual_csvHeader( ob, "node,cluster\n", name );
+    if( cliqueid == NULL ) {
+        return;
+    }
+    for( i=0; i<graph_getNodeCount( graph ); i++ ) {
+        if( name != NULL ) {
+            visual_csvString( ob, name );
+            outbuf_putc( ob, ',' );
+        }
+        outbuf_putlong( ob, i, 0 );
+        outbuf_putc( ob, ',' );
+        outbuf_putlong( ob, cliqueid[i], 0 );
+        outbuf_putc( ob, '\n' );
+    }
+}
+
+/* Zero-edges cost nothing either way, so they aren't edits here */
+void visual_edits( outbuf_t *ob, validate_t *result, const char *name ) {
+    graph_size_t k;
+
+    visual_csvHeader( ob, "node1,node2,value\n", name );
+    if( result == NULL ) {
+        return;
+    }
+    for( k=0; k<result->count; k++ ) {
+        if( result->edits[k].value != 0 ) {
+            if( name != NULL ) {
+                visual_csvString( ob, name );
+                outbuf_putc( ob, ',' );
             }
+            outbuf_putlong( ob, result->edits[k].a, 0 );
+            outbuf_putc( ob, ',' );
+            outbuf_putlong( ob, result->edits[k].b, 0 );
+            outbuf_putc( ob, ',' );
+            outbuf_putlong( ob, result->edits[k].value, 0 );
+            outbuf_putc( ob, '\n' );
+        }
+    }
+}
+
+/* Named instances share one table with an instance column, so the header
+ * is only written before the first one
+ */
+void visual_csvHeader( outbuf_t *ob, const char *columns, const char *name ) {
+    if( name == NULL ) {
+        outbuf_puts( ob, columns );
+    } else if( !visual_header ) {
+        outbuf_puts( ob, "instance," );
+        outbuf_puts( ob, columns );
+        visual_header = 1;
+    }
+}
+
+/* Quoted if needed, with quotes doubled */
+void visual_csvString( outbuf_t *ob, const char *str ) {
+    const char *p;
+
+    for( p = str; *p != '\0' && *p != ',' && *p != '"' && *p != '\n' && *p != '\r'; p++ );
+    if( *p == '\0' ) {
+        outbuf_puts( ob, str );
+        return;
+    }
+    outbuf_putc( ob, '"' );
+    for( ; *str != '\0'; str++ ) {
+        if( *str == '"' ) {
+            outbuf_putc( ob, '"' );
+        }
+        outbuf_putc( ob, *str );
+    }
+    outbuf_putc( ob, '"' );
+}
+
+void visual_json( outbuf_t *ob, graph_t *graph, graph_index_t *cliqueid, validate_t *result, const char *name ) {
+    graph_index_t i;
+    graph_size_t k;
+    int first;
+
+    outbuf_putc( ob, '{' );
+    if( name != NULL ) {
+        outbuf_puts( ob, "\"instance\": " );
+        visual_jsonString( ob, name );
+        outbuf_puts( ob, ", " );
+    }
+    outbuf_puts( ob, "\"cost\": " );
+    if( result == NULL ) {
+        outbuf_puts( ob, "null}\n" );
+        return;
+    }
+    outbuf_putlong( ob, result->cost, 0 );
+    outbuf_puts( ob, ", \"clusters\": [" );
+    for( i=0; i<graph_getNodeCount( graph ); i++ ) {
+        if( i > 0 ) {
+            outbuf_putc( ob, ',' );
+        }
+        outbuf_putlong( ob, cliqueid[i], 0 );
+    }
+    outbuf_puts( ob, "], \"edits\": [" );
+    first = 1;
+    for( k=0; k<result->count; k++ ) {
+        if( result->edits[k].value != 0 ) {
+            outbuf_puts( ob, first ? "[" : ", [" );
+            outbuf_putlong( ob, result->edits[k].a, 0 );
+            outbuf_putc( ob, ',' );
+            outbuf_putlong( ob, result->edits[k].b, 0 );
+            outbuf_putc( ob, ',' );
+            outbuf_putlong( ob, result->edits[k].value, 0 );
+            outbuf_putc( ob, ']' );
+            first = 0;
+        }
+    }
+    outbuf_puts( ob, "]}\n" );
+}
+
+void visual_jsonString( outbuf_t *ob, const char *str ) {
+    static const char hex[] = "0123456789abcdef";
+
+    outbuf_putc( ob, '"' );
+    for( ; *str != '\0'; str++ ) {
+        if( *str == '"' || *str == '\\' ) {
+            outbuf_putc( ob, '\\' );
+            outbuf_putc( ob, *str );
+        } else if( (unsigned char)*str < 0x20 ) {
+            outbuf_puts( ob, "\\u00" );
+            outbuf_putc( ob, hex[(unsigned char)*str >> 4] );
+            outbuf_putc( ob, hex[*str & 15] );
+        } else {
+            outbuf_putc( ob, *str );
         }
     }
+    outbuf_putc( ob, '"' );
 }
@@ -21,7 +21,36 @@
 #include "graph.h"
 #include "graphstate.h"
 
+/* Output formats of visual_show.
+ * Text lists the cliques and the mismatches for reading. CSV writes
+ * "node,cluster" lines, edits writes "node1,node2,value" lines of the
+ * edited pairs, and JSON writes the cost, the cluster ids by node and the
+ * edits as an object on one line. Edits are pairs of nonzero value that
+ * disagree with the clusters.
+ *
+ * All but CSV compare the clusters with every pair of nodes, as the text
+ * format always has, which takes O(N^2) time even for a sparse graph with
+ * few edits. CSV is linear in the nodes.
+ */
+#define VISUAL_FORMAT_TEXT  0
+#define VISUAL_FORMAT_CSV   1
+#define VISUAL_FORMAT_EDITS 2
+#define VISUAL_FORMAT_JSON  3
+#define VISUAL_FORMATS      4
+
+/* Format of visual_show, VISUAL_FORMAT_TEXT initially */
+void visual_setFormat( int format );
+int visual_getFormat( void );
+
 /* List cliques. use basestate to trace merged nodes. */
 void visual_show( graph_t *graph, graph_index_t *cliqueid );
 
+/* As visual_show, for one of many instances. The name is written before
+ * the text output, and in the JSON object, so JSON instances are one per
+ * line. CSV and edits output get an instance column in front, and a single
+ * header before the first instance. A NULL cliqueid is an instance that
+ * wasn't solved: text says so, JSON has a null cost, and CSV has no lines.
+ */
+void visual_showInstance( graph_t *graph, graph_index_t *cliqueid, const char *name );
+
 #endif